@@ -1,37 +1,43 @@
 #include "Activation.h"
 #include "cmath"
+#include "algorithm"
 
 Matrix activation::relu (const Matrix &mat)
 {
-  int rows = mat.get_rows (), cols = mat.get_cols ();
-  Matrix relu_mat (rows, cols);
-  for (int i = 0; i < rows; ++i)
-  {
-    for (int j = 0; j < cols; ++j)
-    {
-      if (mat (i, j) > 0)
-      {
-        relu_mat (i, j) = mat (i, j);
-      }
-    }
-  }
+  Matrix relu_mat (mat);
+  relu_inplace (relu_mat.data (), mat.get_rows () * mat.get_cols ());
   return relu_mat;
 }
 
 Matrix activation::softmax (const Matrix &mat)
 {
-  float exp_sum = 0;
-  int rows = mat.get_rows (), cols = mat.get_cols ();
-  Matrix soft_mat (rows, cols);
-  for (int i = 0; i < rows; ++i)
+  Matrix soft_mat (mat);
+  softmax_inplace (soft_mat.data (), mat.get_rows () * mat.get_cols ());
+  return soft_mat;
+}
+
+void activation::relu_inplace (float *values, int count)
+{
+  for (int i = 0; i < count; ++i)
   {
-    for (int j = 0; j < cols; ++j)
-    {
-      float exp_ij = std::exp (mat (i, j));
-      soft_mat (i, j) = exp_ij;
-      exp_sum += exp_ij;
-    }
+    values[i] = values[i] > 0 ? values[i] : 0;
   }
-  return (1 / exp_sum) * soft_mat;
 }
 
+void activation::softmax_inplace (float *values, int count)
+{
+  float max = values[0], exp_sum = 0;
+  for (int i = 1; i < count; ++i)
+  {
+    max = std::max (max, values[i]);
+  }
+  for (int i = 0; i < count; ++i)
+  {
+    values[i] = std::exp (values[i] - max);
+    exp_sum += values[i];
+  }
+  for (int i = 0; i < count; ++i)
+  {
+    values[i] /= exp_sum;
+  }
+}
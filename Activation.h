@@ -21,11 +21,28 @@ namespace activation
 
     /**
      * An implementation of the Softmax activation function. Applies the
-     * Softmax activation function to the input matrix.
+     * Softmax activation function to all entries of the input matrix.
      * @param mat The input matrix.
      * @returnT he output matrix after applying the Softmax activation
      * function.
      */
     Matrix softmax (const Matrix &mat);
+
+    /**
+     * Applies ReLU in place to a buffer of values. The kernel behind relu,
+     * shared with the training engine.
+     * @param values The values.
+     * @param count The number of values.
+     */
+    void relu_inplace (float *values, int count);
+
+    /**
+     * Applies Softmax in place to a buffer of values, subtracting the
+     * largest value before exponentiating so large inputs do not overflow.
+     * The kernel behind softmax, shared with the training engine.
+     * @param values The values.
+     * @param count The number of values.
+     */
+    void softmax_inplace (float *values, int count);
 }
 #endif //ACTIVATION_H
\ No newline at end of file
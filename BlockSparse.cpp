@@ -0,0 +1,157 @@
+#include "BlockSparse.h"
+#include "stdexcept"
+#include "algorithm"
+
+BlockSparseMatrix::BlockSparseMatrix () : _dims ({1, 1}), _block_rows (1),
+                                          _block_cols (1), _row_ptr (2, 0)
+{}
+
+BlockSparseMatrix::BlockSparseMatrix (const Matrix &mat)
+{
+  _dims.rows = mat.get_rows (), _dims.cols = mat.get_cols ();
+  _block_rows = (_dims.rows + SPARSE_BLOCK_ROWS - 1) / SPARSE_BLOCK_ROWS;
+  _block_cols = (_dims.cols + SPARSE_BLOCK_COLS - 1) / SPARSE_BLOCK_COLS;
+  _row_ptr.assign (_block_rows + 1, 0);
+  const float *src = mat.data ();
+  for (int br = 0; br < _block_rows; ++br)
+  {
+    int r0 = br * SPARSE_BLOCK_ROWS;
+    int r_end = std::min (SPARSE_BLOCK_ROWS, _dims.rows - r0);
+    for (int bc = 0; bc < _block_cols; ++bc)
+    {
+      int c0 = bc * SPARSE_BLOCK_COLS;
+      int c_end = std::min (SPARSE_BLOCK_COLS, _dims.cols - c0);
+      float block[SPARSE_BLOCK_SIZE] = {0};
+      bool non_zero = false;
+      for (int r = 0; r < r_end; ++r)
+      {
+        for (int c = 0; c < c_end; ++c)
+        {
+          float val = src[(r0 + r) * _dims.cols + c0 + c];
+          block[r * SPARSE_BLOCK_COLS + c] = val;
+          non_zero = non_zero || val != 0;
+        }
+      }
+      if (non_zero)
+      {
+        _col_idx.push_back (bc);
+        _values.insert (_values.end (), block, block + SPARSE_BLOCK_SIZE);
+      }
+    }
+    _row_ptr[br + 1] = static_cast<int>(_col_idx.size ());
+  }
+}
+
+float BlockSparseMatrix::block_sparsity () const
+{
+  int total = _block_rows * _block_cols;
+  return 1 - static_cast<float>(get_nnz_blocks ()) / total;
+}
+
+Matrix BlockSparseMatrix::to_matrix () const
+{
+  Matrix mat (_dims.rows, _dims.cols);
+  float *dst = mat.data ();
+  for (int br = 0; br < _block_rows; ++br)
+  {
+    int r0 = br * SPARSE_BLOCK_ROWS;
+    int r_end = std::min (SPARSE_BLOCK_ROWS, _dims.rows - r0);
+    for (int b = _row_ptr[br]; b < _row_ptr[br + 1]; ++b)
+    {
+      int c0 = _col_idx[b] * SPARSE_BLOCK_COLS;
+      int c_end = std::min (SPARSE_BLOCK_COLS, _dims.cols - c0);
+      const float *block = &_values[b * SPARSE_BLOCK_SIZE];
+      for (int r = 0; r < r_end; ++r)
+      {
+        for (int c = 0; c < c_end; ++c)
+        {
+          dst[(r0 + r) * _dims.cols + c0 + c] =
+              block[r * SPARSE_BLOCK_COLS + c];
+        }
+      }
+    }
+  }
+  return mat;
+}
+
+Matrix BlockSparseMatrix::operator* (const Matrix &rhs) const
+{
+  if (_dims.cols != rhs.get_rows ())
+  {
+    throw std::length_error (INVALID_DIM_ERR);
+  }
+  int cols = rhs.get_cols ();
+  Matrix prod (_dims.rows, cols);
+  const float *x = rhs.data ();
+  float *y = prod.data ();
+  if (cols == 1)
+  {
+    multiply_vector (x, y);
+    return prod;
+  }
+  for (int br = 0; br < _block_rows; ++br)
+  {
+    int r0 = br * SPARSE_BLOCK_ROWS;
+    int r_end = std::min (SPARSE_BLOCK_ROWS, _dims.rows - r0);
+    for (int b = _row_ptr[br]; b < _row_ptr[br + 1]; ++b)
+    {
+      int c0 = _col_idx[b] * SPARSE_BLOCK_COLS;
+      int c_end = std::min (SPARSE_BLOCK_COLS, _dims.cols - c0);
+      const float *block = &_values[b * SPARSE_BLOCK_SIZE];
+      for (int r = 0; r < r_end; ++r)
+      {
+        float *y_row = y + (r0 + r) * cols;
+        for (int c = 0; c < c_end; ++c)
+        {
+          float w = block[r * SPARSE_BLOCK_COLS + c];
+          const float *x_row = x + (c0 + c) * cols;
+          for (int j = 0; j < cols; ++j)
+          {
+            y_row[j] += w * x_row[j];
+          }
+        }
+      }
+    }
+  }
+  return prod;
+}
+
+void BlockSparseMatrix::multiply_vector (const float *x, float *y) const
+{
+  static_assert (SPARSE_BLOCK_COLS == 4, "The block dot product is unrolled "
+                                         "for 4 columns.");
+  for (int br = 0; br < _block_rows; ++br)
+  {
+    float acc[SPARSE_BLOCK_ROWS] = {0};
+    for (int b = _row_ptr[br]; b < _row_ptr[br + 1]; ++b)
+    {
+      int c0 = _col_idx[b] * SPARSE_BLOCK_COLS;
+      int c_end = std::min (SPARSE_BLOCK_COLS, _dims.cols - c0);
+      const float *block = &_values[b * SPARSE_BLOCK_SIZE];
+      const float *x_block = x + c0;
+      if (c_end == SPARSE_BLOCK_COLS)
+      {
+        for (int r = 0; r < SPARSE_BLOCK_ROWS; ++r)
+        {
+          const float *w = block + r * SPARSE_BLOCK_COLS;
+          acc[r] += w[0] * x_block[0] + w[1] * x_block[1]
+                    + w[2] * x_block[2] + w[3] * x_block[3];
+        }
+        continue;
+      }
+      for (int r = 0; r < SPARSE_BLOCK_ROWS; ++r)
+      {
+        for (int c = 0; c < c_end; ++c)
+        {
+          acc[r] += block[r * SPARSE_BLOCK_COLS + c] * x_block[c];
+        }
+      }
+    }
+    int r0 = br * SPARSE_BLOCK_ROWS;
+    int r_end = std::min (SPARSE_BLOCK_ROWS, _dims.rows - r0);
+    for (int r = 0; r < r_end; ++r)
+    {
+      y[r0 + r] = acc[r];
+    }
+  }
+}
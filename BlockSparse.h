@@ -0,0 +1,89 @@
+#ifndef BLOCKSPARSE_H
+#define BLOCKSPARSE_H
+
+#include "Matrix.h"
+#include "vector"
+
+#define SPARSE_BLOCK_ROWS 4
+#define SPARSE_BLOCK_COLS 4
+#define SPARSE_BLOCK_SIZE (SPARSE_BLOCK_ROWS * SPARSE_BLOCK_COLS)
+
+/**
+ * A matrix stored in block compressed sparse row (BSR) format. The matrix is
+ * tiled into SPARSE_BLOCK_ROWS x SPARSE_BLOCK_COLS blocks and only blocks
+ * holding at least one non-zero entry are kept, so multiplication skips the
+ * zero blocks entirely. Edge blocks of matrices whose dimensions are not a
+ * multiple of the block size are zero padded.
+ */
+class BlockSparseMatrix
+{
+ public:
+  /**
+   * Constructs an empty 1x1 block-sparse matrix.
+   */
+  BlockSparseMatrix ();
+
+  /**
+   * Constructs a block-sparse matrix holding the non-zero blocks of the given
+   * dense matrix.
+   * @param mat The dense matrix to compress.
+   */
+  explicit BlockSparseMatrix (const Matrix &mat);
+
+  /**
+   * Returns the number of rows in the matrix.
+   * @return The number of rows.
+   */
+  int get_rows () const
+  { return _dims.rows; }
+
+  /**
+   * Returns the number of columns in the matrix.
+   * @return The number of columns.
+   */
+  int get_cols () const
+  { return _dims.cols; }
+
+  /**
+   * Returns the number of stored (non-zero) blocks.
+   * @return The number of stored blocks.
+   */
+  int get_nnz_blocks () const
+  { return static_cast<int>(_col_idx.size ()); }
+
+  /**
+   * Returns the fraction of blocks that are skipped (all-zero).
+   * @return The block sparsity, in the range [0, 1].
+   */
+  float block_sparsity () const;
+
+  /**
+   * Expands the current block-sparse matrix back to a dense matrix. Not
+   * used by inference.
+   * @return The dense matrix.
+   */
+  Matrix to_matrix () const;
+
+  /**
+   * Multiplies the current block-sparse matrix by a dense matrix.
+   * @param rhs The right-hand side dense matrix.
+   * @return The dense product matrix.
+   */
+  Matrix operator* (const Matrix &rhs) const;
+
+ private:
+  /**
+   * Multiplies by a column vector (the inference case): every 4x4 block is
+   * four dot products against the block's 4 input entries, accumulated in
+   * registers and stored once per block row.
+   */
+  void multiply_vector (const float *x, float *y) const;
+
+  matrix_dims _dims;
+  int _block_rows, _block_cols;
+  std::vector<int> _row_ptr; /** Block-row offsets into _col_idx. */
+  std::vector<int> _col_idx; /** Block-column index of each stored block. */
+  std::vector<float> _values; /** Row-major block entries, block by block. */
+};
+
+#endif //BLOCKSPARSE_H
@@ -0,0 +1,123 @@
+#include "Cascade.h"
+#include "stdexcept"
+
+namespace
+{
+    /**
+     * Returns the multiply-adds of one pass through the given layers.
+     */
+    long layer_cost (const matrix_dims layers[], int count)
+    {
+      long cost = 0;
+      for (int l = 0; l < count; ++l)
+      {
+        cost += (long) layers[l].rows * layers[l].cols;
+      }
+      return cost;
+    }
+}
+
+void poolImage (const float *image, float *pooled)
+{
+  const float scale = 1.0f / (PRE_POOL * PRE_POOL);
+  for (int i = 0; i < pre_input_dims.rows; ++i)
+  {
+    for (int j = 0; j < pre_input_dims.cols; ++j)
+    {
+      float sum = 0;
+      for (int di = 0; di < PRE_POOL; ++di)
+      {
+        const float *row = image + (i * PRE_POOL + di) * img_dims.cols;
+        for (int dj = 0; dj < PRE_POOL; ++dj)
+        {
+          sum += row[j * PRE_POOL + dj];
+        }
+      }
+      pooled[i * pre_input_dims.cols + j] = sum * scale;
+    }
+  }
+}
+
+float cascadeCost (const cascade_stats &stats)
+{
+  unsigned long total = stats.handled[0] + stats.handled[1];
+  if (total == 0)
+  {
+    return 0;
+  }
+  float pre = layer_cost (pre_weights_dims, PRE_SIZE);
+  float full = layer_cost (weights_dims, MLP_SIZE);
+  return (pre * total + full * stats.handled[1]) / (full * total);
+}
+
+PreModel::PreModel (const Matrix weights[], const Matrix biases[],
+                    weight_storage storage)
+    : _hidden (weights[0], biases[0], relu, storage),
+      _out (weights[1], biases[1], softmax, storage)
+{}
+
+digit PreModel::operator() (const Matrix &input) const
+{
+  if (input.get_rows () * input.get_cols () != img_dims.rows * img_dims.cols)
+  {
+    throw std::length_error (INVALID_DIM_ERR);
+  }
+  Matrix pooled (pre_input_dims.rows * pre_input_dims.cols, 1);
+  poolImage (input.data (), pooled.data ());
+  Matrix probs = _out (_hidden (pooled));
+  int index = probs.argmax ();
+  return digit{static_cast<unsigned int>(index), probs[index]};
+}
+
+CascadeNetwork::CascadeNetwork (const Matrix weights[], const Matrix biases[],
+                                const Matrix pre_weights[],
+                                const Matrix pre_biases[], float threshold,
+                                weight_storage storage)
+    : _pre (pre_weights, pre_biases, storage),
+      _full (weights, biases, storage), _threshold (threshold)
+{
+  reset_stats ();
+}
+
+digit CascadeNetwork::operator() (Matrix &input, int label) const
+{
+  digit output = _pre (input);
+  if (output.probability >= _threshold)
+  {
+    record (0, output, label);
+    return output;
+  }
+  output = _full (input);
+  record (1, output, label);
+  return output;
+}
+
+void CascadeNetwork::record (int stage, const digit &output, int label) const
+{
+  ++_handled[stage];
+  if (label != NO_LABEL)
+  {
+    ++_labeled[stage];
+    _correct[stage] += output.value == static_cast<unsigned int>(label);
+  }
+}
+
+cascade_stats CascadeNetwork::stats () const
+{
+  cascade_stats snapshot;
+  for (int stage = 0; stage < CASCADE_STAGES; ++stage)
+  {
+    snapshot.handled[stage] = _handled[stage];
+    snapshot.labeled[stage] = _labeled[stage];
+    snapshot.correct[stage] = _correct[stage];
+  }
+  return snapshot;
+}
+
+void CascadeNetwork::reset_stats ()
+{
+  for (int stage = 0; stage < CASCADE_STAGES; ++stage)
+  {
+    _handled[stage] = 0, _labeled[stage] = 0, _correct[stage] = 0;
+  }
+}
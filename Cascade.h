@@ -0,0 +1,142 @@
+#ifndef CASCADE_H
+#define CASCADE_H
+
+#include "MlpNetwork.h"
+#include "atomic"
+
+#define CASCADE_STAGES 2
+#define NO_LABEL (-1)
+#define PRE_SIZE 2
+#define PRE_POOL 2 /** The pre-model sees the mean of PRE_POOL^2 pixels. */
+
+const matrix_dims pre_input_dims = {14, 14};
+const matrix_dims pre_weights_dims[] = {{32, 196},
+                                        {10, 32}};
+const matrix_dims pre_bias_dims[] = {{32, 1},
+                                     {10, 1}};
+
+/**
+ * @struct cascade_stats
+ * @brief Per-stage counters of a CascadeNetwork.
+ * @var handled - images classified by the stage (stage 0 - pre-model,
+ *      stage 1 - full network)
+ * @var labeled - labeled images classified by the stage
+ * @var correct - labeled images the stage classified correctly
+ */
+typedef struct cascade_stats
+{
+    unsigned long handled[CASCADE_STAGES];
+    unsigned long labeled[CASCADE_STAGES];
+    unsigned long correct[CASCADE_STAGES];
+} cascade_stats;
+
+/**
+ * Averages every PRE_POOL x PRE_POOL tile of an image, shrinking an
+ * img_dims image to the pre_input_dims one the pre-model is fed.
+ * @param image The image pixels, row by row.
+ * @param pooled Output buffer of pre_input_dims.rows * pre_input_dims.cols
+ *        values.
+ */
+void poolImage (const float *image, float *pooled);
+
+/**
+ * Returns the average multiply-adds a cascade spent per image, relative to
+ * running the full network on every image: every image pays for the
+ * pre-model, and the images it passes on also pay for the full network.
+ * @param stats The cascade's counters.
+ * @return The relative compute (e.g. 0.25 for a quarter of the full cost).
+ */
+float cascadeCost (const cascade_stats &stats);
+
+/**
+ * The cheap first stage of a cascade: a small MLP (196-32-10) over images
+ * pooled to 14x14, costing about 6% of the full network's multiply-adds.
+ */
+class PreModel
+{
+ public:
+  /**
+   * Constructs the pre-model.
+   * @param weights An array of (2) weight matrices for each layer.
+   * @param biases An array of (2) bias matrices for each layer.
+   * @param storage How the layers store their weights.
+   */
+  PreModel (const Matrix weights[], const Matrix biases[],
+            weight_storage storage = weight_storage::DENSE);
+
+  /**
+   * Applies the pre-model to an image and returns the predicted digit with
+   * its probability.
+   * @param input The img_dims image (any shape with that many entries).
+   * @return The predicted digit.
+   */
+  digit operator() (const Matrix &input) const;
+
+ private:
+  Dense _hidden, _out;
+};
+
+/**
+ * Confidence-gated cascade inference. Every image runs through the cheap
+ * PreModel first. When its top probability reaches the threshold its
+ * prediction is returned; otherwise the image goes on to the full network.
+ * Per-stage hit and accuracy counters are kept (thread-safely) for tuning
+ * the threshold.
+ */
+class CascadeNetwork
+{
+ public:
+  /**
+   * Constructs a cascade over a pre-model and a full network.
+   * @param weights An array of (4) weight matrices for each layer.
+   * @param biases An array of (4) bias matrices for each layer.
+   * @param pre_weights An array of (2) pre-model weight matrices.
+   * @param pre_biases An array of (2) pre-model bias matrices.
+   * @param threshold The pre-model probability at which an image exits
+   *        early.
+   * @param storage How the layers store their weights.
+   */
+  CascadeNetwork (const Matrix weights[], const Matrix biases[],
+                  const Matrix pre_weights[], const Matrix pre_biases[],
+                  float threshold,
+                  weight_storage storage = weight_storage::DENSE);
+
+  /**
+   * Applies the cascade to the input matrix and returns the predicted digit.
+   * @param input The input matrix.
+   * @param label The image's true digit, if known, for the accuracy
+   *        counters.
+   * @return The predicted digit.
+   */
+  digit operator() (Matrix &input, int label = NO_LABEL) const;
+
+  /**
+   * Returns the exit threshold.
+   * @return The threshold.
+   */
+  float get_threshold () const
+  { return _threshold; }
+
+  /**
+   * Returns a snapshot of the per-stage counters.
+   * @return The counters.
+   */
+  cascade_stats stats () const;
+
+  /**
+   * Resets the per-stage counters.
+   */
+  void reset_stats ();
+
+ private:
+  void record (int stage, const digit &output, int label) const;
+
+  PreModel _pre;
+  MlpNetwork _full;
+  float _threshold;
+  mutable std::atomic<unsigned long> _handled[CASCADE_STAGES];
+  mutable std::atomic<unsigned long> _labeled[CASCADE_STAGES];
+  mutable std::atomic<unsigned long> _correct[CASCADE_STAGES];
+};
+
+#endif //CASCADE_H
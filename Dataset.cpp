@@ -0,0 +1,192 @@
+#include "Dataset.h"
+#include "MlpNetwork.h"
+#include "Parameters.h"
+#include "sstream"
+#include "fstream"
+#include "stdexcept"
+#include "cstring"
+#include "cmath"
+#include "algorithm"
+
+#define IDX_IMAGES_MAGIC 0x00000803
+#define IDX_LABELS_MAGIC 0x00000801
+
+namespace
+{
+    /**
+     * Reads a big-endian 32-bit integer, as used by IDX headers.
+     */
+    bool readBigEndian (std::ifstream &is, int &val)
+    {
+      unsigned char bytes[4];
+      if (!is.read (reinterpret_cast<char *>(bytes), sizeof (bytes)))
+      {
+        return false;
+      }
+      val = (bytes[0] << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+      return true;
+    }
+}
+
+dataset loadIdxDataset (const std::string &imagesPath,
+                        const std::string &labelsPath) noexcept (false)
+{
+  std::ifstream images (imagesPath, std::ios::in | std::ios::binary);
+  std::ifstream labels (labelsPath, std::ios::in | std::ios::binary);
+  int magic, count, rows, cols, label_magic, label_count;
+  if (!(images.is_open () && readBigEndian (images, magic)
+        && magic == IDX_IMAGES_MAGIC && readBigEndian (images, count)
+        && readBigEndian (images, rows) && readBigEndian (images, cols)
+        && count > 0 && rows == img_dims.rows && cols == img_dims.cols))
+  {
+    throw std::invalid_argument (DATASET_ERR + imagesPath);
+  }
+  if (!(labels.is_open () && readBigEndian (labels, label_magic)
+        && label_magic == IDX_LABELS_MAGIC
+        && readBigEndian (labels, label_count) && label_count == count))
+  {
+    throw std::invalid_argument (DATASET_ERR + labelsPath);
+  }
+
+  dataset data;
+  data.count = count, data.pixels = rows * cols;
+  std::vector<unsigned char> &pixels = data.bytes;
+  pixels.resize ((size_t) count * data.pixels);
+  data.labels.resize (count);
+  if (!images.read (reinterpret_cast<char *>(pixels.data ()),
+                    (long int) pixels.size ()))
+  {
+    throw std::invalid_argument (DATASET_ERR + imagesPath);
+  }
+  if (!labels.read (reinterpret_cast<char *>(data.labels.data ()), count))
+  {
+    throw std::invalid_argument (DATASET_ERR + labelsPath);
+  }
+  for (unsigned char label: data.labels)
+  {
+    if (label > 9)
+    {
+      throw std::invalid_argument (DATASET_ERR + labelsPath);
+    }
+  }
+  return data;
+}
+
+dataset loadListDataset (const std::string &listPath) noexcept (false)
+{
+  std::ifstream list (listPath);
+  if (!list.is_open ())
+  {
+    throw std::invalid_argument (DATASET_ERR + listPath);
+  }
+  size_t slash = listPath.rfind ('/');
+  std::string dir = slash == std::string::npos ? ""
+                                               : listPath.substr (0, slash + 1);
+  dataset data;
+  data.count = 0, data.pixels = img_dims.rows * img_dims.cols;
+  Matrix img (data.pixels, 1);
+  std::vector<unsigned char> bytes (data.pixels);
+  std::string line;
+  while (std::getline (list, line))
+  {
+    std::istringstream fields (line);
+    std::string path;
+    int label;
+    if (!(fields >> path))
+    {
+      continue;
+    }
+    if (!(fields >> label) || label < 0 || label > 9)
+    {
+      throw std::invalid_argument (DATASET_ERR + listPath);
+    }
+    path = path[0] == '/' ? path : dir + path;
+    if (readFileToMatrix (path, img))
+    {
+      if (!data.bytes.empty ())
+      {
+        // A float32 image among 8-bit ones: convert what was read so far.
+        data.images.resize (data.bytes.size ());
+        for (int k = 0; k < data.count; ++k)
+        {
+          copyDatasetImage (data, k, &data.images[(size_t) k * data.pixels]);
+        }
+        data.bytes = std::vector<unsigned char> ();
+      }
+      data.images.insert (data.images.end (), img.data (),
+                          img.data () + data.pixels);
+    }
+    else if (readFileToBytes (path, bytes))
+    {
+      if (data.count == 0 || !data.bytes.empty ())
+      {
+        data.bytes.insert (data.bytes.end (), bytes.begin (), bytes.end ());
+      }
+      else
+      {
+        for (unsigned char pixel: bytes)
+        {
+          data.images.push_back (pixel / PIXEL_MAX);
+        }
+      }
+    }
+    else
+    {
+      throw std::invalid_argument (DATASET_ERR + path);
+    }
+    data.labels.push_back (static_cast<unsigned char>(label));
+    ++data.count;
+  }
+  if (data.count == 0)
+  {
+    throw std::invalid_argument (DATASET_ERR + listPath);
+  }
+  return data;
+}
+
+unsigned char quantizePixel (float pixel)
+{
+  pixel = std::min (std::max (pixel, 0.0f), 1.0f);
+  return static_cast<unsigned char>(std::lround (pixel * PIXEL_MAX));
+}
+
+void quantizeDataset (dataset &data)
+{
+  if (!data.bytes.empty ())
+  {
+    return;
+  }
+  data.bytes.resize (data.images.size ());
+  for (size_t i = 0; i < data.images.size (); ++i)
+  {
+    data.bytes[i] = quantizePixel (data.images[i]);
+  }
+  data.images = std::vector<float> ();
+}
+
+void copyDatasetImage (const dataset &data, int i, float *dst)
+{
+  size_t offset = (size_t) i * data.pixels;
+  if (data.bytes.empty ())
+  {
+    std::memcpy (dst, &data.images[offset], data.pixels * sizeof (float));
+    return;
+  }
+  const unsigned char *src = &data.bytes[offset];
+  for (int k = 0; k < data.pixels; ++k)
+  {
+    dst[k] = src[k] / PIXEL_MAX;
+  }
+}
+
+Matrix datasetImage (const dataset &data, int i)
+{
+  Matrix img (data.pixels, 1);
+  copyDatasetImage (data, i, img.data ());
+  return img;
+}
+
+const unsigned char *datasetBytes (const dataset &data, int i)
+{
+  return &data.bytes[(size_t) i * data.pixels];
+}
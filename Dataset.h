@@ -0,0 +1,94 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include "Matrix.h"
+#include "string"
+#include "vector"
+
+#define DATASET_ERR "Error: invalid dataset file: "
+
+/**
+ * @struct dataset
+ * @brief A labeled set of images held as one contiguous buffer, in a single
+ * representation: 8-bit pixels when the source was 8-bit, float32 otherwise.
+ * Use datasetImage (), copyDatasetImage () and datasetBytes () to read it.
+ * @var images - count x pixels row-major float32 values in [0, 1], when the
+ *      source was float32 (empty otherwise)
+ * @var bytes - count x pixels row-major 8-bit values in [0, 255], when the
+ *      source was 8-bit (empty otherwise)
+ * @var labels - the digit of every image
+ * @var count - the number of images
+ * @var pixels - the number of pixels in every image
+ */
+typedef struct dataset
+{
+    std::vector<float> images;
+    std::vector<unsigned char> bytes;
+    std::vector<unsigned char> labels;
+    int count, pixels;
+} dataset;
+
+/**
+ * Loads a dataset stored in the MNIST IDX format (an idx3-ubyte images file
+ * and an idx1-ubyte labels file). The pixels are kept as 8-bit values. The
+ * images must be 28x28 and the labels digits in 0..9.
+ * @param imagesPath path of the images file.
+ * @param labelsPath path of the labels file.
+ * @return The loaded dataset.
+ * @throw std::invalid_argument in case of an unreadable or malformed file
+ */
+dataset loadIdxDataset (const std::string &imagesPath,
+                        const std::string &labelsPath) noexcept (false);
+
+/**
+ * Loads a dataset from a list file holding one "image_path label" pair per
+ * line, with image paths relative to the list file's directory. Images are
+ * either 784 float32 values or 784 bytes; 8-bit pixels are kept as such
+ * only when every image is 8-bit, and converted to float32 otherwise.
+ * @param listPath path of the list file.
+ * @return The loaded dataset.
+ * @throw std::invalid_argument in case of an unreadable or malformed file
+ */
+dataset loadListDataset (const std::string &listPath) noexcept (false);
+
+/**
+ * Quantizes a float32 pixel in [0, 1] to an 8-bit pixel in [0, 255],
+ * rounding to nearest (values outside [0, 1] are clamped).
+ * @param pixel The float32 pixel.
+ * @return The 8-bit pixel.
+ */
+unsigned char quantizePixel (float pixel);
+
+/**
+ * Converts a float32 dataset to 8-bit pixels in place (see quantizePixel).
+ * Datasets already holding 8-bit pixels are left unchanged.
+ * @param data The dataset.
+ */
+void quantizeDataset (dataset &data);
+
+/**
+ * Copies the i'th image of a dataset as float32 values in [0, 1], scaling
+ * 8-bit pixels.
+ * @param data The dataset.
+ * @param i The image index.
+ * @param dst Output buffer of data.pixels values.
+ */
+void copyDatasetImage (const dataset &data, int i, float *dst);
+
+/**
+ * Returns the i'th image of a dataset as a column vector.
+ * @param data The dataset.
+ * @param i The image index.
+ * @return A (pixels x 1) matrix.
+ */
+Matrix datasetImage (const dataset &data, int i);
+
+/**
+ * Returns the i'th image of a dataset as 8-bit pixels, without copying.
+ * @param data The dataset, which must hold 8-bit pixels.
+ * @param i The image index.
+ * @return Pointer to the image's data.pixels bytes inside data.bytes.
+ */
+const unsigned char *datasetBytes (const dataset &data, int i);
+
+#endif //DATASET_H
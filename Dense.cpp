@@ -1,14 +1,83 @@
 #include "Matrix.h"
 #include "Dense.h"
+#include "stdexcept"
 
 Dense::Dense (const Matrix &weights, const Matrix &bias, activation_f
-activation_func)
-    : _weights (weights), _bias (bias), _activation_func (activation_func)
-{}
+activation_func, weight_storage storage)
+    : _bias (bias), _activation_func (activation_func), _storage (storage)
+{
+  if (_storage == weight_storage::BLOCK_SPARSE)
+  {
+    _sparse_weights = BlockSparseMatrix (weights);
+  }
+  else if (_storage == weight_storage::DENSE)
+  {
+    _packed_weights = PackedMatrix (weights);
+  }
+  else
+  {
+    half_format format = _storage == weight_storage::FP16
+                         ? half_format::FP16 : half_format::BF16;
+    _packed_weights = PackedMatrix (weights, format);
+  }
+}
 
-Matrix Dense::operator() (const Matrix &input) const
+Matrix Dense::get_weights () const
 {
-  return _activation_func ((_weights * input) + _bias);
+  if (_storage == weight_storage::BLOCK_SPARSE)
+  {
+    return _sparse_weights.to_matrix ();
+  }
+  return _packed_weights.to_matrix ();
 }
 
+Matrix Dense::operator() (const Matrix &input) const
+{
+  if (_storage == weight_storage::BLOCK_SPARSE)
+  {
+    return _activation_func ((_sparse_weights * input) + _bias);
+  }
+  return _activation_func ((_packed_weights * input) + _bias);
+}
 
+Matrix Dense::operator() (const unsigned char *input, int size,
+                          float scale) const
+{
+  int rows = _bias.get_rows (), cols = size;
+  int weight_cols = _storage == weight_storage::BLOCK_SPARSE
+                    ? _sparse_weights.get_cols ()
+                    : _packed_weights.get_cols ();
+  if (cols != weight_cols)
+  {
+    throw std::length_error (INVALID_DIM_ERR);
+  }
+  if (_storage == weight_storage::BLOCK_SPARSE)
+  {
+    Matrix vec (cols, 1);
+    for (int k = 0; k < cols; ++k)
+    {
+      vec[k] = input[k] * scale;
+    }
+    return (*this) (vec);
+  }
+  std::vector<int> nz_idx;
+  std::vector<float> nz_val;
+  for (int k = 0; k < cols; ++k)
+  {
+    if (input[k] != 0)
+    {
+      nz_idx.push_back (k);
+      nz_val.push_back (input[k]);
+    }
+  }
+  Matrix out (rows, 1);
+  float *y = out.data ();
+  const float *b = _bias.data ();
+  _packed_weights.multiply_sparse (nz_idx.data (), nz_val.data (),
+                                   static_cast<int>(nz_idx.size ()), y);
+  for (int i = 0; i < rows; ++i)
+  {
+    y[i] = y[i] * scale + b[i];
+  }
+  return _activation_func (out);
+}
@@ -2,8 +2,26 @@
 #define DENSE_H
 
 #include "Activation.h"
+#include "BlockSparse.h"
+#include "Packed.h"
+#include "vector"
 using namespace activation;
 
+/**
+ * @enum weight_storage
+ * How a Dense layer stores its weights for inference. The weights are
+ * packed into that storage once, when the layer is constructed.
+ * DENSE - a float32 PackedMatrix.
+ * BLOCK_SPARSE - a BlockSparseMatrix; all-zero blocks (e.g. produced by the
+ *                pruning tool) are skipped at inference time.
+ * FP16, BF16 - a PackedMatrix holding 16-bit weights; products accumulate in
+ *              float32.
+ */
+enum class weight_storage
+{
+    DENSE, BLOCK_SPARSE, FP16, BF16
+};
+
 /**
  * Represents a dense layer in a neural network.
  */
@@ -17,21 +35,25 @@ class Dense
    * @param weights The weight matrix of the dense layer.
    * @param bias The bias matrix of the dense layer.
    * @param activation_func The activation function of the dense layer.
+   * @param storage How the weights are stored for inference.
    */
   Dense (const Matrix &weights, const Matrix &bias, activation_f
-  activation_func);
+  activation_func, weight_storage storage = weight_storage::DENSE);
 
   /**
-   * Returns the weight matrix of the current Dense layer object.
+   * Returns the weight matrix of the current Dense layer object. Only the
+   * packed (or block-sparse) weights are kept, so the matrix is unpacked on
+   * every call: a cold path, not used by inference. With 16-bit storage the
+   * matrix holds the rounded weights.
    * @return The weight matrix.
    */
-  Matrix get_weights () const { return _weights; }
+  Matrix get_weights () const;
 
   /**
    * Returns the bias matrix of the current Dense layer object.
    * @return The bias matrix.
    */
-  Matrix get_bias () const { return _bias; }
+  const Matrix &get_bias () const { return _bias; }
 
   /**
    * Returns the activation function of the current Dense layer object.
@@ -39,6 +61,12 @@ class Dense
    */
   activation_f get_activation () const { return _activation_func; }
 
+  /**
+   * Returns the weight storage of the current Dense layer object.
+   * @return The weight storage.
+   */
+  weight_storage get_storage () const { return _storage; }
+
   /**
    * Applies the current Dense layer object on the input and returns an output
    * matrix.
@@ -47,9 +75,25 @@ class Dense
    */
   Matrix operator() (const Matrix &input) const;
 
+  /**
+   * Applies the current Dense layer object on 8-bit input, where the layer's
+   * real input is scale * input. The scale is folded into the kernel: the
+   * raw bytes are multiplied by the packed weight columns of the non-zero
+   * bytes only and the accumulated sums are scaled once per output.
+   * @param input The input bytes, one per weight column.
+   * @param size The number of input bytes.
+   * @param scale The factor that maps a byte to the layer's input value.
+   * @return The output matrix after applying the dense layer.
+   */
+  Matrix operator() (const unsigned char *input, int size,
+                     float scale) const;
+
  private:
-  Matrix _weights, _bias;
+  Matrix _bias;
   activation_f _activation_func;
+  weight_storage _storage;
+  BlockSparseMatrix _sparse_weights; /** Used in BLOCK_SPARSE storage. */
+  PackedMatrix _packed_weights; /** Used in DENSE, FP16 and BF16 storage. */
 };
 
 #endif //DENSE_H
@@ -0,0 +1,177 @@
+#include "Half.h"
+#include "cstring"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include "immintrin.h"
+#define HALF_X86_KERNELS
+#endif
+
+#define FLOAT_EXP_BIAS 127
+#define FP16_EXP_BIAS 15
+
+namespace
+{
+    uint32_t float_bits (float val)
+    {
+      uint32_t bits;
+      std::memcpy (&bits, &val, sizeof (bits));
+      return bits;
+    }
+
+    float bits_float (uint32_t bits)
+    {
+      float val;
+      std::memcpy (&val, &bits, sizeof (val));
+      return val;
+    }
+
+    void decode_scalar (const uint16_t *src, float *dst, int count,
+                        half_format format)
+    {
+      for (int i = 0; i < count; ++i)
+      {
+        dst[i] = format == half_format::FP16 ? half::from_fp16 (src[i])
+                                             : half::from_bf16 (src[i]);
+      }
+    }
+
+#ifdef HALF_X86_KERNELS
+    __attribute__((target("avx,f16c")))
+    void decode_fp16_f16c (const uint16_t *src, float *dst, int count)
+    {
+      int i = 0;
+      for (; i + 8 <= count; i += 8)
+      {
+        __m128i h = _mm_loadu_si128 (
+            reinterpret_cast<const __m128i *>(src + i));
+        _mm256_storeu_ps (dst + i, _mm256_cvtph_ps (h));
+      }
+      decode_scalar (src + i, dst + i, count - i, half_format::FP16);
+    }
+
+    __attribute__((target("avx2")))
+    void decode_bf16_avx2 (const uint16_t *src, float *dst, int count)
+    {
+      int i = 0;
+      for (; i + 8 <= count; i += 8)
+      {
+        __m128i h = _mm_loadu_si128 (
+            reinterpret_cast<const __m128i *>(src + i));
+        __m256i w = _mm256_slli_epi32 (_mm256_cvtepu16_epi32 (h), 16);
+        _mm256_storeu_ps (dst + i, _mm256_castsi256_ps (w));
+      }
+      decode_scalar (src + i, dst + i, count - i, half_format::BF16);
+    }
+
+    // The F16C kernel converts 8 values into a 256-bit AVX register.
+    const bool has_f16c = __builtin_cpu_supports ("f16c") &&
+                          __builtin_cpu_supports ("avx");
+    const bool has_avx2 = __builtin_cpu_supports ("avx2");
+#endif
+}
+
+uint16_t half::to_fp16 (float val)
+{
+  uint32_t bits = float_bits (val);
+  uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+  int exp = static_cast<int>((bits >> 23) & 0xFF);
+  uint32_t mant = bits & 0x7FFFFF;
+  if (exp == 0xFF)
+  {
+    return sign | 0x7C00 | (mant ? 0x200 : 0);
+  }
+  exp = exp - FLOAT_EXP_BIAS + FP16_EXP_BIAS;
+  if (exp >= 0x1F)
+  {
+    return sign | 0x7C00;
+  }
+  if (exp <= 0)
+  {
+    if (exp < -10)
+    {
+      return sign;
+    }
+    mant |= 0x800000;
+    int shift = 14 - exp;
+    uint32_t half_mant = mant >> shift;
+    uint32_t rest = mant & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (half_mant & 1)))
+    {
+      ++half_mant;
+    }
+    return sign | static_cast<uint16_t>(half_mant);
+  }
+  uint32_t half_bits = (static_cast<uint32_t>(exp) << 10) | (mant >> 13);
+  uint32_t rest = mant & 0x1FFF;
+  if (rest > 0x1000 || (rest == 0x1000 && (half_bits & 1)))
+  {
+    ++half_bits; // May carry into the exponent, rounding up to infinity.
+  }
+  return sign | static_cast<uint16_t>(half_bits);
+}
+
+float half::from_fp16 (uint16_t bits)
+{
+  uint32_t sign = static_cast<uint32_t>(bits & 0x8000) << 16;
+  uint32_t exp = (bits >> 10) & 0x1F, mant = bits & 0x3FF;
+  if (exp == 0x1F)
+  {
+    return bits_float (sign | 0x7F800000 | (mant << 13));
+  }
+  if (exp == 0)
+  {
+    if (mant == 0)
+    {
+      return bits_float (sign);
+    }
+    exp = FLOAT_EXP_BIAS - FP16_EXP_BIAS + 1;
+    while (!(mant & 0x400))
+    {
+      mant <<= 1;
+      --exp;
+    }
+    mant &= 0x3FF;
+    return bits_float (sign | (exp << 23) | (mant << 13));
+  }
+  exp += FLOAT_EXP_BIAS - FP16_EXP_BIAS;
+  return bits_float (sign | (exp << 23) | (mant << 13));
+}
+
+uint16_t half::to_bf16 (float val)
+{
+  uint32_t bits = float_bits (val);
+  if ((bits & 0x7FFFFFFF) > 0x7F800000)
+  {
+    return static_cast<uint16_t>((bits >> 16) | 0x40);
+  }
+  bits += 0x7FFF + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+float half::from_bf16 (uint16_t bits)
+{
+  return bits_float (static_cast<uint32_t>(bits) << 16);
+}
+
+uint16_t half::encode (float val, half_format format)
+{
+  return format == half_format::FP16 ? to_fp16 (val) : to_bf16 (val);
+}
+
+void half::decode (const uint16_t *src, float *dst, int count,
+                   half_format format)
+{
+#ifdef HALF_X86_KERNELS
+  if (format == half_format::FP16 && has_f16c)
+  {
+    decode_fp16_f16c (src, dst, count);
+    return;
+  }
+  if (format == half_format::BF16 && has_avx2)
+  {
+    decode_bf16_avx2 (src, dst, count);
+    return;
+  }
+#endif
+  decode_scalar (src, dst, count, format);
+}
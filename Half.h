@@ -0,0 +1,68 @@
+#ifndef HALF_H
+#define HALF_H
+
+#include "cstdint"
+
+/**
+ * @enum half_format
+ * 16-bit floating-point formats weights can be stored in.
+ * FP16 - IEEE 754 binary16 (5 exponent bits, 10 mantissa bits).
+ * BF16 - bfloat16 (the upper half of a float32: 8 exponent bits, 7 mantissa
+ *        bits).
+ */
+enum class half_format
+{
+    FP16, BF16
+};
+
+namespace half
+{
+    /**
+     * Converts a float32 value to fp16, rounding to nearest even.
+     * @param val The float32 value.
+     * @return The fp16 bit pattern.
+     */
+    uint16_t to_fp16 (float val);
+
+    /**
+     * Converts an fp16 value to float32 (exact).
+     * @param bits The fp16 bit pattern.
+     * @return The float32 value.
+     */
+    float from_fp16 (uint16_t bits);
+
+    /**
+     * Converts a float32 value to bf16, rounding to nearest even.
+     * @param val The float32 value.
+     * @return The bf16 bit pattern.
+     */
+    uint16_t to_bf16 (float val);
+
+    /**
+     * Converts a bf16 value to float32 (exact).
+     * @param bits The bf16 bit pattern.
+     * @return The float32 value.
+     */
+    float from_bf16 (uint16_t bits);
+
+    /**
+     * Converts a float32 value to the given 16-bit format.
+     * @param val The float32 value.
+     * @param format The target format.
+     * @return The 16-bit bit pattern.
+     */
+    uint16_t encode (float val, half_format format);
+
+    /**
+     * Converts a run of 16-bit values to float32. Uses F16C / AVX2 when the
+     * CPU supports them and a scalar loop otherwise.
+     * @param src The 16-bit values.
+     * @param dst The float32 output buffer.
+     * @param count The number of values to convert.
+     * @param format The format of src.
+     */
+    void decode (const uint16_t *src, float *dst, int count,
+                 half_format format);
+}
+
+#endif //HALF_H
@@ -0,0 +1,272 @@
+#include "InferencePool.h"
+#include "fstream"
+#include "sstream"
+#include "algorithm"
+#include "chrono"
+#ifdef __linux__
+#include "sched.h"
+#endif
+
+#define NODE_DIR "/sys/devices/system/node/"
+#define CHUNK_SIZE 64
+
+namespace
+{
+    /**
+     * Parses a sysfs list such as "0-3,8,10-11".
+     */
+    std::vector<int> parseList (const std::string &list)
+    {
+      std::vector<int> ids;
+      std::stringstream ss (list);
+      std::string range;
+      while (std::getline (ss, range, ','))
+      {
+        if (range.empty () || range[0] == '\n')
+        {
+          continue;
+        }
+        size_t dash = range.find ('-');
+        int first = std::stoi (range.substr (0, dash));
+        int last = dash == std::string::npos ? first
+                                             : std::stoi (range.substr (dash
+                                                                        + 1));
+        for (int id = first; id <= last; ++id)
+        {
+          ids.push_back (id);
+        }
+      }
+      return ids;
+    }
+
+    bool readLine (const std::string &path, std::string &line)
+    {
+      std::ifstream is (path);
+      return is.is_open () && std::getline (is, line) && !line.empty ();
+    }
+
+    std::vector<int> allowedCpus ()
+    {
+      std::vector<int> cpus;
+#ifdef __linux__
+      cpu_set_t set;
+      if (sched_getaffinity (0, sizeof (set), &set) == 0)
+      {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+          if (CPU_ISSET (cpu, &set))
+          {
+            cpus.push_back (cpu);
+          }
+        }
+      }
+#endif
+      if (cpus.empty ())
+      {
+        int count = std::max (1u, std::thread::hardware_concurrency ());
+        for (int cpu = 0; cpu < count; ++cpu)
+        {
+          cpus.push_back (cpu);
+        }
+      }
+      return cpus;
+    }
+
+    void pinCurrentThread (int cpu)
+    {
+#ifdef __linux__
+      cpu_set_t set;
+      CPU_ZERO (&set);
+      CPU_SET (cpu, &set);
+      sched_setaffinity (0, sizeof (set), &set);
+#else
+      (void) cpu;
+#endif
+    }
+}
+
+std::vector<numa_node> detectTopology ()
+{
+  std::vector<int> allowed = allowedCpus ();
+  std::vector<numa_node> nodes;
+  std::string online;
+  if (readLine (NODE_DIR "online", online))
+  {
+    for (int id: parseList (online))
+    {
+      std::string cpulist;
+      if (!readLine (NODE_DIR "node" + std::to_string (id) + "/cpulist",
+                     cpulist))
+      {
+        continue;
+      }
+      numa_node node{id, {}};
+      for (int cpu: parseList (cpulist))
+      {
+        if (std::find (allowed.begin (), allowed.end (), cpu) !=
+            allowed.end ())
+        {
+          node.cpus.push_back (cpu);
+        }
+      }
+      if (!node.cpus.empty ())
+      {
+        nodes.push_back (node);
+      }
+    }
+  }
+  if (nodes.empty ())
+  {
+    nodes.push_back (numa_node{0, allowed});
+  }
+  return nodes;
+}
+
+InferencePool::InferencePool (const Matrix weights[], const Matrix biases[],
+                              weight_storage storage, bool numa_aware,
+                              int threads)
+    : _topology (detectTopology ()), _numa_aware (numa_aware),
+      _storage (storage), _workers_busy (0), _job_id (0), _stop (false),
+      _job (nullptr), _results (nullptr), _latencies (nullptr),
+      _next (0)
+{
+  int cpus = 0;
+  for (auto &node: _topology)
+  {
+    cpus += static_cast<int>(node.cpus.size ());
+  }
+  int count = threads > 0 ? threads : cpus;
+  int nodes = _numa_aware ? static_cast<int>(_topology.size ()) : 1;
+  std::vector<size_t> used (_topology.size (), 0);
+  for (int w = 0; w < count; ++w)
+  {
+    int node = w % nodes;
+    _worker_node.push_back (node);
+    const std::vector<int> &node_cpus = _topology[node].cpus;
+    _worker_cpu.push_back (_numa_aware ? node_cpus[used[node]++ %
+                                                   node_cpus.size ()] : -1);
+  }
+  _replicas.resize (std::min (nodes, count));
+  _replicas_pending = static_cast<int>(_replicas.size ());
+
+  for (int w = 0; w < count; ++w)
+  {
+    _workers.emplace_back (&InferencePool::work, this, w, weights, biases);
+  }
+  std::unique_lock<std::mutex> lock (_mutex);
+  _done_cv.wait (lock, [this]
+  { return _replicas_pending == 0; });
+}
+
+InferencePool::~InferencePool ()
+{
+  {
+    std::lock_guard<std::mutex> lock (_mutex);
+    _stop = true;
+  }
+  _job_cv.notify_all ();
+  for (auto &worker: _workers)
+  {
+    worker.join ();
+  }
+}
+
+void InferencePool::work (int id, const Matrix *weights, const Matrix *biases)
+{
+  int node = _worker_node[id];
+  if (_worker_cpu[id] >= 0)
+  {
+    pinCurrentThread (_worker_cpu[id]);
+  }
+  if (id < static_cast<int>(_replicas.size ()))
+  {
+    // Built on this (pinned) thread, so its pages are allocated on the node.
+    std::unique_ptr<MlpNetwork> replica (new MlpNetwork (weights, biases,
+                                                         _storage));
+    std::lock_guard<std::mutex> lock (_mutex);
+    _replicas[node] = std::move (replica);
+    if (--_replicas_pending == 0)
+    {
+      _done_cv.notify_all ();
+    }
+  }
+
+  unsigned long seen = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock (_mutex);
+      _job_cv.wait (lock, [&]
+      { return _stop || _job_id != seen; });
+      if (_stop)
+      {
+        return;
+      }
+      seen = _job_id;
+    }
+    const MlpNetwork &mlp = *_replicas[node];
+    const dataset &data = *_job;
+    for (int start = _next.fetch_add (CHUNK_SIZE); start < data.count;
+         start = _next.fetch_add (CHUNK_SIZE))
+    {
+      int end = std::min (data.count, start + CHUNK_SIZE);
+      for (int i = start; i < end; ++i)
+      {
+        Matrix img = datasetImage (data, i);
+        auto begin = std::chrono::steady_clock::now ();
+        (*_results)[i] = mlp (img);
+        if (_latencies)
+        {
+          std::chrono::duration<double, std::micro> elapsed =
+              std::chrono::steady_clock::now () - begin;
+          (*_latencies)[i] = elapsed.count ();
+        }
+      }
+    }
+    std::lock_guard<std::mutex> lock (_mutex);
+    if (--_workers_busy == 0)
+    {
+      _done_cv.notify_all ();
+    }
+  }
+}
+
+std::vector<digit> InferencePool::classify (const dataset &data,
+                                            std::vector<double> *latencies)
+{
+  std::vector<digit> results (data.count);
+  if (latencies)
+  {
+    latencies->assign (data.count, 0);
+  }
+  std::unique_lock<std::mutex> lock (_mutex);
+  _job = &data, _results = &results, _latencies = latencies, _next = 0;
+  _workers_busy = size ();
+  ++_job_id;
+  _job_cv.notify_all ();
+  _done_cv.wait (lock, [this]
+  { return _workers_busy == 0; });
+  _job = nullptr, _results = nullptr, _latencies = nullptr;
+  return results;
+}
+
+void InferencePool::report (std::ostream &os) const
+{
+  os << "NUMA nodes: " << _topology.size () << std::endl;
+  for (auto &node: _topology)
+  {
+    os << "  node " << node.id << ": " << node.cpus.size () << " cpus [";
+    for (size_t i = 0; i < node.cpus.size (); ++i)
+    {
+      os << (i ? "," : "") << node.cpus[i];
+    }
+    os << "]" << std::endl;
+  }
+  os << "Workers: " << size () << (_numa_aware ? " (pinned)" : "")
+     << ", network replicas: " << _replicas.size () << std::endl;
+  for (int w = 0; _numa_aware && w < size (); ++w)
+  {
+    os << "  worker " << w << ": node " << _topology[_worker_node[w]].id
+       << ", cpu " << _worker_cpu[w] << std::endl;
+  }
+}
@@ -0,0 +1,108 @@
+#ifndef INFERENCEPOOL_H
+#define INFERENCEPOOL_H
+
+#include "MlpNetwork.h"
+#include "Dataset.h"
+#include "ostream"
+#include "memory"
+#include "thread"
+#include "mutex"
+#include "condition_variable"
+#include "atomic"
+
+/**
+ * @struct numa_node
+ * @brief A NUMA node and the CPUs of it this process may run on.
+ * @var id - the node id
+ * @var cpus - the node's allowed CPU ids
+ */
+typedef struct numa_node
+{
+    int id;
+    std::vector<int> cpus;
+} numa_node;
+
+/**
+ * Detects the NUMA topology from /sys/devices/system/node, restricted to
+ * the CPUs this process may run on. Hosts without that information are
+ * reported as a single node holding every allowed CPU.
+ * @return The nodes with at least one allowed CPU.
+ */
+std::vector<numa_node> detectTopology ();
+
+/**
+ * A pool of worker threads that classify batches of images.
+ *
+ * In NUMA-aware mode every worker is pinned to one CPU, workers are spread
+ * evenly over the nodes, and each node gets its own replica of the network,
+ * built (and so first-touched) by a worker of that node, so the read-only
+ * weights are streamed from local memory. Otherwise all workers share one
+ * network and are left to the scheduler.
+ */
+class InferencePool
+{
+ public:
+  /**
+   * Starts the workers and builds the network replicas.
+   * @param weights An array of (4) weight matrices for each layer.
+   * @param biases An array of (4) bias matrices for each layer.
+   * @param storage How the networks store their weights.
+   * @param numa_aware Whether to replicate per node and pin the workers.
+   * @param threads Number of workers (0 - one per allowed CPU).
+   */
+  InferencePool (const Matrix weights[], const Matrix biases[],
+                 weight_storage storage, bool numa_aware, int threads = 0);
+
+  /**
+   * Stops the workers.
+   */
+  ~InferencePool ();
+
+  InferencePool (const InferencePool &) = delete;
+  InferencePool &operator= (const InferencePool &) = delete;
+
+  /**
+   * Returns the number of workers.
+   * @return The number of workers.
+   */
+  int size () const
+  { return static_cast<int>(_workers.size ()); }
+
+  /**
+   * Classifies every image of a dataset, spread over the workers.
+   * @param data The images to classify.
+   * @param latencies If not null, filled with every image's classification
+   *        time, in microseconds.
+   * @return The predicted digit of every image.
+   */
+  std::vector<digit> classify (const dataset &data,
+                               std::vector<double> *latencies = nullptr);
+
+  /**
+   * Prints the detected topology and how workers and replicas were placed.
+   * @param os The output stream.
+   */
+  void report (std::ostream &os) const;
+
+ private:
+  void work (int id, const Matrix *weights, const Matrix *biases);
+
+  std::vector<numa_node> _topology;
+  bool _numa_aware;
+  weight_storage _storage;
+  std::vector<std::unique_ptr<MlpNetwork>> _replicas; /** One per node. */
+  std::vector<int> _worker_node, _worker_cpu;
+  std::vector<std::thread> _workers;
+
+  std::mutex _mutex;
+  std::condition_variable _job_cv, _done_cv;
+  int _replicas_pending, _workers_busy;
+  unsigned long _job_id;
+  bool _stop;
+  const dataset *_job;
+  std::vector<digit> *_results;
+  std::vector<double> *_latencies;
+  std::atomic<int> _next;
+};
+
+#endif //INFERENCEPOOL_H
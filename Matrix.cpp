@@ -8,6 +8,96 @@
 #define DEF_DIM 1
 #define DEF_VAL 0
 #define MIN_VAL 0.1
+#define TRANSPOSE_BASE 256 /** Entries below which recursion stops. */
+
+namespace
+{
+    /**
+     * Cache-oblivious out-of-place transpose of rows [r0, r1) x columns
+     * [c0, c1) of the rows x cols matrix src into dst (cols x rows). The
+     * longer side is halved until the block fits in cache at every level.
+     */
+    void transpose_copy (const float *src, float *dst, int rows, int cols,
+                         int r0, int r1, int c0, int c1)
+    {
+      if ((r1 - r0) * (c1 - c0) <= TRANSPOSE_BASE)
+      {
+        for (int i = r0; i < r1; ++i)
+        {
+          for (int j = c0; j < c1; ++j)
+          {
+            dst[j * rows + i] = src[i * cols + j];
+          }
+        }
+      }
+      else if (r1 - r0 >= c1 - c0)
+      {
+        int mid = (r0 + r1) / 2;
+        transpose_copy (src, dst, rows, cols, r0, mid, c0, c1);
+        transpose_copy (src, dst, rows, cols, mid, r1, c0, c1);
+      }
+      else
+      {
+        int mid = (c0 + c1) / 2;
+        transpose_copy (src, dst, rows, cols, r0, r1, c0, mid);
+        transpose_copy (src, dst, rows, cols, r0, r1, mid, c1);
+      }
+    }
+
+    /**
+     * Swaps rows [r0, r1) x columns [c0, c1) of the n x n matrix mat with
+     * its mirror block across the diagonal (the block lies above it).
+     */
+    void transpose_swap (float *mat, int n, int r0, int r1, int c0, int c1)
+    {
+      if ((r1 - r0) * (c1 - c0) <= TRANSPOSE_BASE)
+      {
+        for (int i = r0; i < r1; ++i)
+        {
+          for (int j = c0; j < c1; ++j)
+          {
+            std::swap (mat[i * n + j], mat[j * n + i]);
+          }
+        }
+      }
+      else if (r1 - r0 >= c1 - c0)
+      {
+        int mid = (r0 + r1) / 2;
+        transpose_swap (mat, n, r0, mid, c0, c1);
+        transpose_swap (mat, n, mid, r1, c0, c1);
+      }
+      else
+      {
+        int mid = (c0 + c1) / 2;
+        transpose_swap (mat, n, r0, r1, c0, mid);
+        transpose_swap (mat, n, r0, r1, mid, c1);
+      }
+    }
+
+    /**
+     * Cache-oblivious in-place transpose of the diagonal block [lo, hi) of
+     * the n x n matrix mat: both diagonal halves are transposed recursively
+     * and the two off-diagonal quarters swapped.
+     */
+    void transpose_square (float *mat, int n, int lo, int hi)
+    {
+      if ((hi - lo) * (hi - lo) <= TRANSPOSE_BASE)
+      {
+        for (int i = lo; i < hi; ++i)
+        {
+          for (int j = i + 1; j < hi; ++j)
+          {
+            std::swap (mat[i * n + j], mat[j * n + i]);
+          }
+        }
+        return;
+      }
+      int mid = (lo + hi) / 2;
+      transpose_square (mat, n, lo, mid);
+      transpose_square (mat, n, mid, hi);
+      transpose_swap (mat, n, lo, mid, mid, hi);
+    }
+}
 
 Matrix::Matrix (int rows, int cols)
 {
@@ -72,23 +162,6 @@ float Matrix::norm () const
   return std::sqrt (sum);
 }
 
-Matrix Matrix::dot (const Matrix &mat) const
-{
-  if (_dims.rows != mat._dims.rows || _dims.cols != mat._dims.cols)
-  {
-    throw std::length_error (INVALID_DIM_ERR);
-  }
-  Matrix prod (*this);
-  for (int i = 0; i < _dims.rows; ++i)
-  {
-    for (int j = 0; j < _dims.cols; ++j)
-    {
-      prod (i, j) *= mat (i, j);
-    }
-  }
-  return prod;
-}
-
 Matrix &Matrix::vectorize ()
 {
   _dims.rows *= _dims.cols;
@@ -109,26 +182,24 @@ float Matrix::sum () const
   return sum;
 }
 
+void transpose (const float *src, float *dst, int rows, int cols)
+{
+  transpose_copy (src, dst, rows, cols, 0, rows, 0, cols);
+}
+
 Matrix &Matrix::transpose ()
 {
-  Matrix temp (_dims.cols, _dims.rows);
-  for (int i = 0; i < _dims.rows; ++i)
+  int rows = _dims.rows, cols = _dims.cols;
+  if (rows == cols)
   {
-    for (int j = 0; j < _dims.cols; ++j)
-    {
-      temp (j, i) = (*this) (i, j);
-    }
+    transpose_square (_matrix, rows, 0, rows);
+    return *this;
   }
+  float *transposed = new float[rows * cols];
+  ::transpose (_matrix, transposed, rows, cols);
   delete[] _matrix;
-  _dims.rows = temp._dims.rows, _dims.cols = temp._dims.cols;
-  _matrix = new float[_dims.rows * _dims.cols];
-  for (int i = 0; i < _dims.rows; ++i)
-  {
-    for (int j = 0; j < _dims.cols; ++j)
-    {
-      (*this) (i, j) = temp (i, j);
-    }
-  }
+  _matrix = transposed;
+  _dims.rows = cols, _dims.cols = rows;
   return *this;
 }
 
@@ -147,23 +218,6 @@ int Matrix::argmax () const
   return max_idx;
 }
 
-Matrix operator+ (const Matrix &lhs, const Matrix &rhs)
-{
-  if (lhs._dims.rows != rhs._dims.rows || lhs._dims.cols != rhs._dims.cols)
-  {
-    throw std::length_error (INVALID_DIM_ERR);
-  }
-  Matrix sum (lhs);
-  for (int i = 0; i < lhs._dims.rows; ++i)
-  {
-    for (int j = 0; j < lhs._dims.cols; ++j)
-    {
-      sum (i, j) += rhs (i, j);
-    }
-  }
-  return sum;
-}
-
 Matrix &Matrix::operator= (const Matrix &rhs)
 {
   if (this != &rhs)
@@ -177,57 +231,6 @@ Matrix &Matrix::operator= (const Matrix &rhs)
   return *this;
 }
 
-Matrix &Matrix::operator+= (const Matrix &rhs)
-{
-  if (_dims.rows != rhs._dims.rows || _dims.cols != rhs._dims.cols)
-  {
-    throw std::length_error (INVALID_DIM_ERR);
-  }
-  (*this) = (*this) + rhs;
-  return *this;
-}
-
-Matrix operator* (const Matrix &lhs, const Matrix &rhs)
-{
-  if (lhs._dims.cols != rhs._dims.rows)
-  {
-    throw std::length_error (INVALID_DIM_ERR);
-  }
-  int rows = lhs._dims.rows, cols = rhs._dims.cols, n = lhs._dims.cols;
-  Matrix prod (rows, cols);
-  for (int i = 0; i < rows; ++i)
-  {
-    for (int j = 0; j < cols; ++j)
-    {
-      float entry_ij = 0;
-      for (int k = 0; k < n; ++k)
-      {
-        entry_ij += (lhs (i, k) * rhs (k, j));
-      }
-      prod (i, j) = entry_ij;
-    }
-  }
-  return prod;
-}
-
-Matrix Matrix::operator* (float c) const
-{
-  Matrix mult (_dims.rows, _dims.cols);
-  for (int i = 0; i < _dims.rows; ++i)
-  {
-    for (int j = 0; j < _dims.cols; ++j)
-    {
-      mult (i, j) = c * (*this) (i, j);
-    }
-  }
-  return mult;
-}
-
-Matrix operator* (const float c, Matrix &rhs)
-{
-  return rhs * c;
-}
-
 float &Matrix::operator() (int i, int j)
 {
   if (i >= _dims.rows || i < 0 || j >= _dims.cols || j < 0)
@@ -5,6 +5,8 @@
 #define RANGE_ERR "Error: Index out of range."
 #define STREAM_ERR "Error: A runtime error occurred."
 #include "ostream"
+#include "utility"
+#include "MatrixExpr.h"
 
 /**
  * @struct matrix_dims
@@ -16,9 +18,11 @@ typedef struct matrix_dims
 } matrix_dims;
 
 /**
- * Represents a matrix of floating-point numbers.
+ * Represents a matrix of floating-point numbers. Arithmetic operators build
+ * lazy expressions (see MatrixExpr.h) that are evaluated in a single pass
+ * when assigned to a Matrix.
  */
-class Matrix
+class Matrix : public MatrixExpr<Matrix>
 {
  public:
   /**
@@ -41,6 +45,13 @@ class Matrix
    */
   Matrix (const Matrix &mat);
 
+  /**
+   * Constructs a Matrix object by evaluating a matrix expression.
+   * @param expr The expression to evaluate.
+   */
+  template<typename E>
+  Matrix (const MatrixExpr<E> &expr);
+
   /**
    * Destructor for the Matrix object. Deletes the current Matrix object's
    * _matrix field.
@@ -61,6 +72,22 @@ class Matrix
   int get_cols () const
   { return _dims.cols; }
 
+  /**
+   * Returns a pointer to the current Matrix object's row-major storage, for
+   * kernels that iterate over the entries without per-element bounds checks.
+   * @return Pointer to the first element.
+   */
+  float *data ()
+  { return _matrix; }
+
+  /**
+   * Returns a read-only pointer to the current Matrix object's row-major
+   * storage.
+   * @return Pointer to the first element.
+   */
+  const float *data () const
+  { return _matrix; }
+
   /**
    * Returns the Frobenius norm of the current Matrix object.
    * @return the Frobenius norm of the matrix.
@@ -79,11 +106,22 @@ class Matrix
   void plain_print () const;
 
   /**
-   * Transposes the current Matrix object.
+   * Transposes the current Matrix object, with a cache-oblivious blocked
+   * traversal: in place for square matrices, into a single new buffer
+   * otherwise.
    * @return Reference to the transposed matrix.
    */
   Matrix &transpose ();
 
+  /**
+   * Returns a lazy transposed view of the current Matrix object. Nothing is
+   * moved; the view reads the matrix with swapped indices and can be used
+   * directly as an operand of matrix products and other expressions.
+   * @return The transposed view.
+   */
+  MatrixTranspose transposed () const
+  { return MatrixTranspose (*this); }
+
   /**
    * Vectorizes the current Matrix object by reshaping it into a single column.
    * @return Reference to the vectorized matrix.
@@ -99,19 +137,13 @@ class Matrix
 
   /**
    * Performs element-wise multiplication between the current Matrix object and
-   * another Matrix object (aka Hadamard product).
+   * another matrix (aka Hadamard product).
    * @param mat The matrix to perform element-wise multiplication with.
-   * @return The resulting matrix after element-wise multiplication.
+   * @return The (lazy) resulting matrix after element-wise multiplication.
    */
-  Matrix dot (const Matrix &mat) const;
-
-  /**
- * Overloaded addition operator for adding two matrices.
- * @param lhs The left-hand side matrix.
- * @param rhs The right-hand side matrix.
- * @return The sum of the two matrices.
- */
-  friend Matrix operator+ (const Matrix &lhs, const Matrix &rhs);
+  template<typename E>
+  MatrixHadamard<Matrix, E> dot (const MatrixExpr<E> &mat) const
+  { return MatrixHadamard<Matrix, E> (*this, mat.self ()); }
 
   /**
    * Overloaded assignment operator for assigning the values of some matrix to
@@ -122,37 +154,40 @@ class Matrix
   Matrix &operator= (const Matrix &rhs);
 
   /**
-   * Overloaded compound assignment operator for adding a matrix to the current
-   * Matrix object.
-   * @param rhs The matrix to be added.
-   * @return Reference to the modified matrix after addition.
+   * Overloaded assignment operator for evaluating a matrix expression into
+   * the current Matrix object in a single pass.
+   * @param rhs The expression to be assigned.
+   * @return Reference to the assigned matrix.
    */
-  Matrix &operator+= (const Matrix &rhs);
+  template<typename E>
+  Matrix &operator= (const MatrixExpr<E> &rhs);
 
   /**
-   * Overloaded multiplication operator for matrix multiplication.
-   * @param lhs The left-hand side matrix.
-   * @param rhs The right-hand side matrix.
-   * @return The product of the two matrices.
+   * Overloaded compound assignment operator for adding a matrix (or matrix
+   * expression) to the current Matrix object in place.
+   * @param rhs The matrix to be added.
+   * @return Reference to the modified matrix after addition.
    */
-  friend Matrix operator* (const Matrix &lhs, const Matrix &rhs);
+  template<typename E>
+  Matrix &operator+= (const MatrixExpr<E> &rhs);
 
   /**
-   * Overloaded multiplication operator for scalar multiplication from the
-   * right-hand side of the current Matrix object.
-   * @param c The scalar value.
-   * @return The resulting matrix after scalar multiplication.
+   * Returns the (i, j) entry without bounds checks, for expression
+   * evaluation.
+   * @param i The row index.
+   * @param j The column index.
+   * @return The value of the matrix element at the specified indices.
    */
-  Matrix operator* (float c) const;
+  float coeff (int i, int j) const
+  { return _matrix[i * _dims.cols + j]; }
 
   /**
-   * Overloaded multiplication operator for scalar multiplication from the
-   * left-hand side of a matrix.
-   * @param c The scalar value.
-   * @param rhs The matrix.
-   * @return The resulting matrix after scalar multiplication.
+   * A Matrix is read entry by entry at the position being written, so
+   * evaluating it into its own buffer is safe.
+   * @return false.
    */
-  friend Matrix operator* (float c, Matrix &rhs);
+  bool aliases (const float *) const
+  { return false; }
 
   /**
    * Overloaded function call operator for accessing and modifying the
@@ -206,7 +241,151 @@ class Matrix
   friend std::istream &operator>> (std::istream &is, Matrix &rhs);
 
  private:
+  /**
+   * Evaluates an expression of the current Matrix object's dimensions into
+   * its buffer.
+   */
+  template<typename E>
+  void evaluate (const E &expr);
+
   matrix_dims _dims;
   float *_matrix;
 };
+
+/**
+ * Cache-oblivious out-of-place transpose of a raw row-major buffer, the same
+ * one Matrix::transpose uses for non-square matrices.
+ * @param src The rows x cols source buffer.
+ * @param dst The cols x rows destination buffer; must not alias src.
+ * @param rows Number of rows of src.
+ * @param cols Number of columns of src.
+ */
+void transpose (const float *src, float *dst, int rows, int cols);
+
+/**
+ * Overloaded multiplication operator for matrix multiplication.
+ * @param lhs The left-hand side matrix.
+ * @param rhs The right-hand side matrix.
+ * @return The (lazy) product of the two matrices.
+ */
+inline MatrixProduct<Matrix, Matrix> operator* (const Matrix &lhs,
+                                                const Matrix &rhs)
+{
+  return MatrixProduct<Matrix, Matrix> (lhs, rhs);
+}
+
+/**
+ * Overloaded multiplication operator for multiplying a transposed view by a
+ * matrix, without materializing the transpose.
+ * @param lhs The left-hand side transposed view.
+ * @param rhs The right-hand side matrix.
+ * @return The (lazy) product.
+ */
+inline MatrixProduct<MatrixTranspose, Matrix>
+operator* (const MatrixTranspose &lhs, const Matrix &rhs)
+{
+  return MatrixProduct<MatrixTranspose, Matrix> (lhs, rhs);
+}
+
+/**
+ * Overloaded multiplication operator for multiplying a matrix by a
+ * transposed view, without materializing the transpose.
+ * @param lhs The left-hand side matrix.
+ * @param rhs The right-hand side transposed view.
+ * @return The (lazy) product.
+ */
+inline MatrixProduct<Matrix, MatrixTranspose>
+operator* (const Matrix &lhs, const MatrixTranspose &rhs)
+{
+  return MatrixProduct<Matrix, MatrixTranspose> (lhs, rhs);
+}
+
+/**
+ * Overloaded multiplication operator for multiplying two transposed views.
+ * @param lhs The left-hand side transposed view.
+ * @param rhs The right-hand side transposed view.
+ * @return The (lazy) product.
+ */
+inline MatrixProduct<MatrixTranspose, MatrixTranspose>
+operator* (const MatrixTranspose &lhs, const MatrixTranspose &rhs)
+{
+  return MatrixProduct<MatrixTranspose, MatrixTranspose> (lhs, rhs);
+}
+
+inline int MatrixTranspose::get_rows () const
+{ return _mat.get_cols (); }
+
+inline int MatrixTranspose::get_cols () const
+{ return _mat.get_rows (); }
+
+inline float MatrixTranspose::coeff (int i, int j) const
+{ return _mat.coeff (j, i); }
+
+inline const float *MatrixTranspose::data () const
+{ return _mat.data (); }
+
+template<typename E>
+Matrix::Matrix (const MatrixExpr<E> &expr)
+    : _dims ({expr.self ().get_rows (), expr.self ().get_cols ()}),
+      _matrix (new float[_dims.rows * _dims.cols])
+{
+  evaluate (expr.self ());
+}
+
+template<typename E>
+void Matrix::evaluate (const E &expr)
+{
+  for (int i = 0; i < _dims.rows; ++i)
+  {
+    float *row = _matrix + i * _dims.cols;
+    for (int j = 0; j < _dims.cols; ++j)
+    {
+      row[j] = expr.coeff (i, j);
+    }
+  }
+}
+
+template<typename E>
+Matrix &Matrix::operator= (const MatrixExpr<E> &rhs)
+{
+  const E &expr = rhs.self ();
+  if (expr.aliases (_matrix))
+  {
+    Matrix temp (expr);
+    std::swap (_dims, temp._dims);
+    std::swap (_matrix, temp._matrix);
+    return *this;
+  }
+  if (_dims.rows != expr.get_rows () || _dims.cols != expr.get_cols ())
+  {
+    delete[] _matrix;
+    _dims.rows = expr.get_rows (), _dims.cols = expr.get_cols ();
+    _matrix = new float[_dims.rows * _dims.cols];
+  }
+  evaluate (expr);
+  return *this;
+}
+
+template<typename E>
+Matrix &Matrix::operator+= (const MatrixExpr<E> &rhs)
+{
+  const E &expr = rhs.self ();
+  if (_dims.rows != expr.get_rows () || _dims.cols != expr.get_cols ())
+  {
+    throw std::length_error (INVALID_DIM_ERR);
+  }
+  if (expr.aliases (_matrix))
+  {
+    return (*this) += Matrix (expr);
+  }
+  for (int i = 0; i < _dims.rows; ++i)
+  {
+    float *row = _matrix + i * _dims.cols;
+    for (int j = 0; j < _dims.cols; ++j)
+    {
+      row[j] += expr.coeff (i, j);
+    }
+  }
+  return *this;
+}
 #endif //MATRIX_H
\ No newline at end of file
@@ -0,0 +1,263 @@
+// MatrixExpr.h
+#ifndef MATRIXEXPR_H
+#define MATRIXEXPR_H
+#include "stdexcept"
+
+class Matrix;
+
+/**
+ * Base of every lazily evaluated matrix expression (CRTP). An expression
+ * only records its operands; the arithmetic runs in a single loop once the
+ * expression is assigned to (or used to construct) a Matrix, so chains of
+ * element-wise operations produce no intermediate matrices.
+ *
+ * Every expression E provides:
+ *  int get_rows () const, int get_cols () const - the result dimensions.
+ *  float coeff (int i, int j) const - the (i, j) entry of the result, with no
+ *      bounds checks.
+ *  bool aliases (const float *buf) const - whether evaluating the expression
+ *      entry by entry into buf would read an entry of buf other than the one
+ *      being written, in which case it is evaluated into a temporary first.
+ *
+ * Expressions hold references to the matrices they read, so they must be
+ * consumed within the full expression that created them (do not store them
+ * in auto variables).
+ * @tparam E The concrete expression type.
+ */
+template<typename E>
+class MatrixExpr
+{
+ public:
+  /**
+   * Returns the current expression as its concrete type.
+   * @return Reference to the concrete expression.
+   */
+  const E &self () const
+  { return static_cast<const E &>(*this); }
+};
+
+/**
+ * @struct expr_operand
+ * @brief How an expression node stores an operand: matrices by reference,
+ *        (small, temporary) expression nodes by value.
+ */
+template<typename E>
+struct expr_operand
+{
+    typedef const E type;
+};
+
+template<>
+struct expr_operand<Matrix>
+{
+    typedef const Matrix &type;
+};
+
+/**
+ * Lazy transposed view of a matrix. Reads the matrix with swapped indices
+ * instead of moving its entries.
+ */
+class MatrixTranspose : public MatrixExpr<MatrixTranspose>
+{
+ public:
+  explicit MatrixTranspose (const Matrix &mat) : _mat (mat)
+  {}
+
+  int get_rows () const;
+
+  int get_cols () const;
+
+  float coeff (int i, int j) const;
+
+  /**
+   * Returns the storage of the underlying matrix.
+   */
+  const float *data () const;
+
+  /**
+   * Entries are read out of position, so evaluating the view into the
+   * underlying matrix's own buffer is unsafe.
+   */
+  bool aliases (const float *buf) const
+  { return data () == buf; }
+
+ private:
+  const Matrix &_mat;
+};
+
+/**
+ * Lazy element-wise sum of two expressions.
+ */
+template<typename L, typename R>
+class MatrixSum : public MatrixExpr<MatrixSum<L, R>>
+{
+ public:
+  MatrixSum (const L &lhs, const R &rhs) : _lhs (lhs), _rhs (rhs)
+  {
+    if (lhs.get_rows () != rhs.get_rows () ||
+        lhs.get_cols () != rhs.get_cols ())
+    {
+      throw std::length_error (INVALID_DIM_ERR);
+    }
+  }
+
+  int get_rows () const
+  { return _lhs.get_rows (); }
+
+  int get_cols () const
+  { return _lhs.get_cols (); }
+
+  float coeff (int i, int j) const
+  { return _lhs.coeff (i, j) + _rhs.coeff (i, j); }
+
+  bool aliases (const float *buf) const
+  { return _lhs.aliases (buf) || _rhs.aliases (buf); }
+
+ private:
+  typename expr_operand<L>::type _lhs;
+  typename expr_operand<R>::type _rhs;
+};
+
+/**
+ * Lazy element-wise (Hadamard) product of two expressions.
+ */
+template<typename L, typename R>
+class MatrixHadamard : public MatrixExpr<MatrixHadamard<L, R>>
+{
+ public:
+  MatrixHadamard (const L &lhs, const R &rhs) : _lhs (lhs), _rhs (rhs)
+  {
+    if (lhs.get_rows () != rhs.get_rows () ||
+        lhs.get_cols () != rhs.get_cols ())
+    {
+      throw std::length_error (INVALID_DIM_ERR);
+    }
+  }
+
+  int get_rows () const
+  { return _lhs.get_rows (); }
+
+  int get_cols () const
+  { return _lhs.get_cols (); }
+
+  float coeff (int i, int j) const
+  { return _lhs.coeff (i, j) * _rhs.coeff (i, j); }
+
+  bool aliases (const float *buf) const
+  { return _lhs.aliases (buf) || _rhs.aliases (buf); }
+
+ private:
+  typename expr_operand<L>::type _lhs;
+  typename expr_operand<R>::type _rhs;
+};
+
+/**
+ * Lazy product of an expression and a scalar.
+ */
+template<typename E>
+class MatrixScaled : public MatrixExpr<MatrixScaled<E>>
+{
+ public:
+  MatrixScaled (const E &expr, float c) : _expr (expr), _c (c)
+  {}
+
+  int get_rows () const
+  { return _expr.get_rows (); }
+
+  int get_cols () const
+  { return _expr.get_cols (); }
+
+  float coeff (int i, int j) const
+  { return _c * _expr.coeff (i, j); }
+
+  bool aliases (const float *buf) const
+  { return _expr.aliases (buf); }
+
+ private:
+  typename expr_operand<E>::type _expr;
+  float _c;
+};
+
+/**
+ * Lazy matrix product. Every entry is evaluated as the inner product of a
+ * row of the left-hand side and a column of the right-hand side, so a
+ * matrix-vector product feeding an element-wise chain (e.g. W * x + b)
+ * writes each output entry once. Both operands must be matrices or
+ * transposed views of matrices, so that entries of the operands are never
+ * recomputed.
+ */
+template<typename L, typename R>
+class MatrixProduct : public MatrixExpr<MatrixProduct<L, R>>
+{
+ public:
+  MatrixProduct (const L &lhs, const R &rhs) : _lhs (lhs), _rhs (rhs)
+  {
+    if (lhs.get_cols () != rhs.get_rows ())
+    {
+      throw std::length_error (INVALID_DIM_ERR);
+    }
+  }
+
+  int get_rows () const
+  { return _lhs.get_rows (); }
+
+  int get_cols () const
+  { return _rhs.get_cols (); }
+
+  float coeff (int i, int j) const
+  {
+    float entry_ij = 0;
+    for (int k = 0; k < _lhs.get_cols (); ++k)
+    {
+      entry_ij += _lhs.coeff (i, k) * _rhs.coeff (k, j);
+    }
+    return entry_ij;
+  }
+
+  bool aliases (const float *buf) const
+  { return _lhs.data () == buf || _rhs.data () == buf; }
+
+ private:
+  typename expr_operand<L>::type _lhs;
+  typename expr_operand<R>::type _rhs;
+};
+
+/**
+ * Overloaded addition operator for adding two matrices.
+ * @param lhs The left-hand side matrix.
+ * @param rhs The right-hand side matrix.
+ * @return The (lazy) sum of the two matrices.
+ */
+template<typename L, typename R>
+MatrixSum<L, R> operator+ (const MatrixExpr<L> &lhs, const MatrixExpr<R> &rhs)
+{
+  return MatrixSum<L, R> (lhs.self (), rhs.self ());
+}
+
+/**
+ * Overloaded multiplication operator for scalar multiplication from the
+ * right-hand side of a matrix.
+ * @param lhs The matrix.
+ * @param c The scalar value.
+ * @return The (lazy) resulting matrix after scalar multiplication.
+ */
+template<typename E>
+MatrixScaled<E> operator* (const MatrixExpr<E> &lhs, float c)
+{
+  return MatrixScaled<E> (lhs.self (), c);
+}
+
+/**
+ * Overloaded multiplication operator for scalar multiplication from the
+ * left-hand side of a matrix.
+ * @param c The scalar value.
+ * @param rhs The matrix.
+ * @return The (lazy) resulting matrix after scalar multiplication.
+ */
+template<typename E>
+MatrixScaled<E> operator* (float c, const MatrixExpr<E> &rhs)
+{
+  return MatrixScaled<E> (rhs.self (), c);
+}
+
+#endif //MATRIXEXPR_H
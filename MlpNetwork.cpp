@@ -1,15 +1,32 @@
 #include "MlpNetwork.h"
 #include "Matrix.h"
 
-MlpNetwork::MlpNetwork (const Matrix weights[], const Matrix biases[]) :
-    _in (weights[0], biases[0], relu), _h1 (weights[1], biases[1], relu),
-    _h2 (weights[2], biases[2], relu), _out (weights[3], biases[3], softmax)
+MlpNetwork::MlpNetwork (const Matrix weights[], const Matrix biases[],
+                        weight_storage storage) :
+    _in (weights[0], biases[0], relu, storage),
+    _h1 (weights[1], biases[1], relu, storage),
+    _h2 (weights[2], biases[2], relu, storage),
+    _out (weights[3], biases[3], softmax, storage)
 {}
 
 digit MlpNetwork::operator() (Matrix &input) const
 {
   input.vectorize ();
-  Matrix r1 = _in (input);
+  return classify (_in (input));
+}
+
+digit MlpNetwork::operator() (const std::vector<unsigned char> &image) const
+{
+  return (*this) (image.data (), static_cast<int>(image.size ()));
+}
+
+digit MlpNetwork::operator() (const unsigned char *image, int size) const
+{
+  return classify (_in (image, size, 1 / PIXEL_MAX));
+}
+
+digit MlpNetwork::classify (const Matrix &r1) const
+{
   Matrix r2 = _h1 (r1);
   Matrix r3 = _h2 (r2);
   Matrix r4 = _out (r3);
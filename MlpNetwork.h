@@ -6,6 +6,7 @@
 #include "Dense.h"
 
 #define MLP_SIZE 4
+#define PIXEL_MAX 255.0f /** An 8-bit pixel p stands for p / PIXEL_MAX. */
 
 /**
  * @struct digit
@@ -37,8 +38,10 @@ class MlpNetwork
    * Constructs an instance of an MLP network.
    * @param weights An array of (4) weight matrices for each layer.
    * @param biases An array of (4) bias matrices for each layer.
+   * @param storage How every layer stores its weights for inference.
    */
-  MlpNetwork (const Matrix weights[], const Matrix biases[]);
+  MlpNetwork (const Matrix weights[], const Matrix biases[],
+              weight_storage storage = weight_storage::DENSE);
 
   /**
    * Applies the MLP network to the input matrix and returns the predicted
@@ -49,7 +52,35 @@ class MlpNetwork
    */
   digit operator() (Matrix &input) const;
 
+  /**
+   * Applies the MLP network to an 8-bit image and returns the predicted
+   * digit. The conversion of the pixels to [0, 1] is folded into the first
+   * layer's kernel.
+   *
+   * @param image The image pixels, row by row.
+   * @return The predicted digit.
+   */
+  digit operator() (const std::vector<unsigned char> &image) const;
+
+  /**
+   * Applies the MLP network to an 8-bit image held in a caller's buffer
+   * (e.g. a dataset) and returns the predicted digit.
+   *
+   * @param image The image pixels, row by row.
+   * @param size The number of pixels.
+   * @return The predicted digit.
+   */
+  digit operator() (const unsigned char *image, int size) const;
+
  private:
+  /**
+   * Applies the layers following the first one and returns the predicted
+   * digit.
+   * @param r1 The output of the first layer.
+   * @return The predicted digit.
+   */
+  digit classify (const Matrix &r1) const;
+
   Dense _in, _h1, _h2, _out; /** All 4 layers of the network. */
 };
 
@@ -0,0 +1,147 @@
+#include "ModelHandle.h"
+#include "Parameters.h"
+#include "chrono"
+#include "csignal"
+#include "iostream"
+#include "sys/stat.h"
+
+#define RELOAD_MSG "Model reloaded, generation: "
+#define RELOAD_ERR "Error: model reload failed, keeping the current model: "
+
+namespace
+{
+    volatile std::sig_atomic_t reload_requested = 0;
+
+    void request_reload (int)
+    {
+      reload_requested = 1;
+    }
+
+    bool operator!= (const timespec &lhs, const timespec &rhs)
+    {
+      return lhs.tv_sec != rhs.tv_sec || lhs.tv_nsec != rhs.tv_nsec;
+    }
+}
+
+ModelHandle::ModelHandle (char *paths[], weight_storage storage)
+noexcept (false)
+    : _paths (paths, paths + MLP_SIZE * 2), _storage (storage),
+      _generation (0), _watching (false)
+{
+  reload ();
+}
+
+ModelHandle::~ModelHandle ()
+{
+  stop_watching ();
+}
+
+std::shared_ptr<const MlpNetwork> ModelHandle::acquire () const
+{
+  return std::atomic_load (&_current);
+}
+
+unsigned long ModelHandle::generation () const
+{
+  return _generation;
+}
+
+void ModelHandle::reload () noexcept (false)
+{
+  std::lock_guard<std::mutex> lock (_reload_mutex);
+  std::vector<char *> paths;
+  for (auto &path: _paths)
+  {
+    paths.push_back (&path[0]);
+  }
+  Matrix weights[MLP_SIZE], biases[MLP_SIZE];
+  loadParameters (paths.data (), weights, biases, _storage);
+  std::shared_ptr<const MlpNetwork> next =
+      std::make_shared<const MlpNetwork> (weights, biases, _storage);
+  std::atomic_store (&_current, next);
+  ++_generation;
+}
+
+std::vector<timespec> ModelHandle::modification_times () const
+{
+  std::vector<timespec> times;
+  for (auto &path: _paths)
+  {
+    struct stat st = {};
+    stat (path.c_str (), &st);
+    times.push_back (st.st_mtim);
+  }
+  return times;
+}
+
+void ModelHandle::start_watching (int interval_ms)
+{
+  std::lock_guard<std::mutex> lock (_watch_mutex);
+  if (_watching)
+  {
+    return;
+  }
+  struct sigaction action = {};
+  action.sa_handler = request_reload;
+  action.sa_flags = SA_RESTART; // Do not fail reads interrupted by SIGHUP.
+  sigemptyset (&action.sa_mask);
+  sigaction (SIGHUP, &action, nullptr);
+  _watching = true;
+  _watcher = std::thread (&ModelHandle::watch, this, interval_ms);
+}
+
+void ModelHandle::stop_watching ()
+{
+  {
+    std::lock_guard<std::mutex> lock (_watch_mutex);
+    if (!_watching)
+    {
+      return;
+    }
+    _watching = false;
+  }
+  _watch_cv.notify_all ();
+  _watcher.join ();
+}
+
+void ModelHandle::watch (int interval_ms)
+{
+  std::vector<timespec> loaded = modification_times (), previous = loaded;
+  std::unique_lock<std::mutex> lock (_watch_mutex);
+  while (_watching)
+  {
+    _watch_cv.wait_for (lock, std::chrono::milliseconds (interval_ms));
+    if (!_watching)
+    {
+      break;
+    }
+    // A model push rewrites the files one at a time: reload only once every
+    // modification time has held still for a whole interval, so a network
+    // never mixes new and old layers.
+    std::vector<timespec> current = modification_times ();
+    bool changed = false, settled = true;
+    for (size_t i = 0; i < current.size (); ++i)
+    {
+      changed = changed || current[i] != loaded[i];
+      settled = settled && !(current[i] != previous[i]);
+    }
+    previous = current;
+    if (!((changed && settled) || reload_requested))
+    {
+      continue;
+    }
+    reload_requested = 0;
+    loaded = current;
+    lock.unlock ();
+    try
+    {
+      reload ();
+      std::cerr << RELOAD_MSG << generation () << std::endl;
+    }
+    catch (const std::exception &error)
+    {
+      std::cerr << RELOAD_ERR << error.what () << std::endl;
+    }
+    lock.lock ();
+  }
+}
@@ -0,0 +1,103 @@
+#ifndef MODELHANDLE_H
+#define MODELHANDLE_H
+
+#include "MlpNetwork.h"
+#include "string"
+#include "vector"
+#include "memory"
+#include "thread"
+#include "mutex"
+#include "condition_variable"
+#include "atomic"
+#include "ctime"
+
+#define DEF_WATCH_INTERVAL_MS 500
+
+/**
+ * A handle to the current MLP network of a long-running process, which can
+ * be swapped for a newly loaded network without stopping inference.
+ *
+ * Callers acquire() a reference to the current network and keep using it
+ * for the whole request. A reload loads and packs the new network off to the
+ * side and then atomically publishes it; requests already in flight finish
+ * on the network they acquired, and each retired network is freed when the
+ * last request holding it releases it.
+ *
+ * Reloads are triggered explicitly (reload()), or by a watcher thread that
+ * reloads on SIGHUP and after the parameter files change. A change is only
+ * picked up once no file's modification time has moved for a whole watch
+ * interval, so all files of a push must be written without pausing longer
+ * than that between them (or the push should end with a SIGHUP instead). A
+ * failed reload (e.g. a file caught mid-write) keeps the current network and
+ * is retried on the next change.
+ */
+class ModelHandle
+{
+ public:
+  /**
+   * Loads the network from the given parameter files.
+   * @param paths array of (2 * MLP_SIZE) paths: the layers' weights followed
+   *        by the layers' biases.
+   * @param storage How the network stores its weights.
+   * @throw std::invalid_argument in case of an invalid parameter file
+   */
+  ModelHandle (char *paths[], weight_storage storage) noexcept (false);
+
+  /**
+   * Stops the watcher thread, if running.
+   */
+  ~ModelHandle ();
+
+  ModelHandle (const ModelHandle &) = delete;
+  ModelHandle &operator= (const ModelHandle &) = delete;
+
+  /**
+   * Returns the current network. The network stays valid for as long as
+   * the returned pointer is held, even if a newer one is published.
+   * @return The current network.
+   */
+  std::shared_ptr<const MlpNetwork> acquire () const;
+
+  /**
+   * Returns the number of networks published so far (1 after
+   * construction).
+   * @return The model generation.
+   */
+  unsigned long generation () const;
+
+  /**
+   * Loads the parameter files again and publishes the new network.
+   * @throw std::invalid_argument in case of an invalid parameter file, in
+   *        which case the current network is kept
+   */
+  void reload () noexcept (false);
+
+  /**
+   * Starts a thread that reloads the network on SIGHUP and when the
+   * parameter files have changed and then stayed unchanged for a whole
+   * interval. Reload errors are reported to stderr.
+   * @param interval_ms How often the files are checked, in milliseconds.
+   */
+  void start_watching (int interval_ms = DEF_WATCH_INTERVAL_MS);
+
+  /**
+   * Stops the watcher thread.
+   */
+  void stop_watching ();
+
+ private:
+  std::vector<timespec> modification_times () const;
+  void watch (int interval_ms);
+
+  std::vector<std::string> _paths;
+  weight_storage _storage;
+  std::shared_ptr<const MlpNetwork> _current;
+  std::atomic<unsigned long> _generation;
+  std::mutex _reload_mutex; /** Serializes reloads. */
+  std::mutex _watch_mutex;
+  std::condition_variable _watch_cv;
+  bool _watching;
+  std::thread _watcher;
+};
+
+#endif //MODELHANDLE_H
@@ -0,0 +1,153 @@
+#include "Packed.h"
+#include "stdexcept"
+#include "algorithm"
+
+namespace
+{
+    /**
+     * Copies mat into panels of PANEL_ROWS rows, each stored column by
+     * column, converting every entry with conv.
+     */
+    template<typename T, typename F>
+    void pack (const Matrix &mat, int panels, std::vector<T> &dst,
+               const F &conv)
+    {
+      int rows = mat.get_rows (), cols = mat.get_cols ();
+      dst.assign ((size_t) panels * cols * PANEL_ROWS, conv (0.0f));
+      const float *src = mat.data ();
+      for (int i = 0; i < rows; ++i)
+      {
+        T *panel = &dst[(size_t) (i / PANEL_ROWS) * cols * PANEL_ROWS];
+        for (int k = 0; k < cols; ++k)
+        {
+          panel[k * PANEL_ROWS + i % PANEL_ROWS] = conv (src[i * cols + k]);
+        }
+      }
+    }
+}
+
+PackedMatrix::PackedMatrix () : PackedMatrix (Matrix ())
+{}
+
+PackedMatrix::PackedMatrix (const Matrix &mat)
+    : _dims ({mat.get_rows (), mat.get_cols ()}),
+      _panels ((mat.get_rows () + PANEL_ROWS - 1) / PANEL_ROWS),
+      _is_half (false), _format (half_format::FP16)
+{
+  pack (mat, _panels, _values, [] (float val)
+  { return val; });
+}
+
+PackedMatrix::PackedMatrix (const Matrix &mat, half_format format)
+    : _dims ({mat.get_rows (), mat.get_cols ()}),
+      _panels ((mat.get_rows () + PANEL_ROWS - 1) / PANEL_ROWS),
+      _is_half (true), _format (format)
+{
+  pack (mat, _panels, _half_values, [format] (float val)
+  { return half::encode (val, format); });
+}
+
+const float *PackedMatrix::panel (int p, std::vector<float> &scratch) const
+{
+  size_t size = (size_t) _dims.cols * PANEL_ROWS;
+  if (!_is_half)
+  {
+    return &_values[p * size];
+  }
+  scratch.resize (size);
+  half::decode (&_half_values[p * size], scratch.data (),
+                static_cast<int>(size), _format);
+  return scratch.data ();
+}
+
+Matrix PackedMatrix::to_matrix () const
+{
+  Matrix mat (_dims.rows, _dims.cols);
+  float *dst = mat.data ();
+  std::vector<float> scratch;
+  for (int p = 0; p < _panels; ++p)
+  {
+    const float *w = panel (p, scratch);
+    int r_end = std::min (PANEL_ROWS, _dims.rows - p * PANEL_ROWS);
+    for (int r = 0; r < r_end; ++r)
+    {
+      for (int k = 0; k < _dims.cols; ++k)
+      {
+        dst[(p * PANEL_ROWS + r) * _dims.cols + k] = w[k * PANEL_ROWS + r];
+      }
+    }
+  }
+  return mat;
+}
+
+Matrix PackedMatrix::operator* (const Matrix &rhs) const
+{
+  if (_dims.cols != rhs.get_rows ())
+  {
+    throw std::length_error (INVALID_DIM_ERR);
+  }
+  int n = _dims.cols, cols = rhs.get_cols ();
+  Matrix prod (_dims.rows, cols);
+  const float *x = rhs.data ();
+  float *y = prod.data ();
+  std::vector<float> scratch;
+  for (int p = 0; p < _panels; ++p)
+  {
+    const float *w = panel (p, scratch);
+    int r_end = std::min (PANEL_ROWS, _dims.rows - p * PANEL_ROWS);
+    for (int j = 0; j < cols; ++j)
+    {
+      float acc[PANEL_ROWS] = {0};
+      for (int k = 0; k < n; ++k)
+      {
+        float x_kj = x[k * cols + j];
+        for (int r = 0; r < PANEL_ROWS; ++r)
+        {
+          acc[r] += w[k * PANEL_ROWS + r] * x_kj;
+        }
+      }
+      for (int r = 0; r < r_end; ++r)
+      {
+        y[(p * PANEL_ROWS + r) * cols + j] = acc[r];
+      }
+    }
+  }
+  return prod;
+}
+
+void PackedMatrix::multiply_sparse (const int *idx, const float *val,
+                                    int nnz, float *out) const
+{
+  size_t size = (size_t) _dims.cols * PANEL_ROWS;
+  std::vector<uint16_t> gathered (_is_half ? nnz * PANEL_ROWS : 0);
+  std::vector<float> decoded (gathered.size ());
+  for (int p = 0; p < _panels; ++p)
+  {
+    int r_end = std::min (PANEL_ROWS, _dims.rows - p * PANEL_ROWS);
+    if (_is_half)
+    {
+      // Decode only the touched columns of a 16-bit panel, in one batch.
+      for (int n = 0; n < nnz; ++n)
+      {
+        std::copy_n (&_half_values[p * size + idx[n] * PANEL_ROWS],
+                     PANEL_ROWS, &gathered[n * PANEL_ROWS]);
+      }
+      half::decode (gathered.data (), decoded.data (), nnz * PANEL_ROWS,
+                    _format);
+    }
+    float acc[PANEL_ROWS] = {0};
+    for (int n = 0; n < nnz; ++n)
+    {
+      const float *w_col = _is_half ? &decoded[n * PANEL_ROWS]
+                                    : &_values[p * size + idx[n] * PANEL_ROWS];
+      for (int r = 0; r < PANEL_ROWS; ++r)
+      {
+        acc[r] += w_col[r] * val[n];
+      }
+    }
+    for (int r = 0; r < r_end; ++r)
+    {
+      out[p * PANEL_ROWS + r] = acc[r];
+    }
+  }
+}
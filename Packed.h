@@ -0,0 +1,96 @@
+#ifndef PACKED_H
+#define PACKED_H
+
+#include "Matrix.h"
+#include "Half.h"
+#include "vector"
+
+#define PANEL_ROWS 8
+
+/**
+ * A read-only matrix repacked once into the layout the inference kernels
+ * stream: the rows are grouped into panels of PANEL_ROWS rows, and each
+ * panel is stored column by column (PANEL_ROWS consecutive entries per
+ * column), with the last panel zero padded. A product then walks every panel
+ * contiguously, accumulating PANEL_ROWS outputs at once, and a sparse input
+ * only touches the panel columns of its non-zero entries. The entries are
+ * kept as float32 or, with a half_format, as 16-bit floats that are decoded
+ * a panel at a time and accumulated in float32.
+ */
+class PackedMatrix
+{
+ public:
+  /**
+   * Constructs an empty 1x1 packed matrix.
+   */
+  PackedMatrix ();
+
+  /**
+   * Packs a matrix with float32 entries.
+   * @param mat The matrix to pack.
+   */
+  explicit PackedMatrix (const Matrix &mat);
+
+  /**
+   * Packs a matrix with 16-bit entries.
+   * @param mat The matrix to pack.
+   * @param format The 16-bit format to store the entries in.
+   */
+  PackedMatrix (const Matrix &mat, half_format format);
+
+  /**
+   * Returns the number of rows in the matrix.
+   * @return The number of rows.
+   */
+  int get_rows () const
+  { return _dims.rows; }
+
+  /**
+   * Returns the number of columns in the matrix.
+   * @return The number of columns.
+   */
+  int get_cols () const
+  { return _dims.cols; }
+
+  /**
+   * Unpacks the current packed matrix back to a row-major float32 matrix
+   * (decoding 16-bit entries). Not used by inference.
+   * @return The unpacked matrix.
+   */
+  Matrix to_matrix () const;
+
+  /**
+   * Multiplies the current packed matrix by a dense matrix.
+   * @param rhs The right-hand side matrix.
+   * @return The product matrix.
+   */
+  Matrix operator* (const Matrix &rhs) const;
+
+  /**
+   * Multiplies the current packed matrix by a sparse column vector given as
+   * its non-zero entries.
+   * @param idx The indices of the non-zero entries.
+   * @param val The values of the non-zero entries.
+   * @param nnz The number of non-zero entries.
+   * @param out Output buffer of get_rows () entries, overwritten with the
+   *        product.
+   */
+  void multiply_sparse (const int *idx, const float *val, int nnz,
+                        float *out) const;
+
+ private:
+  /**
+   * Returns the float32 entries of a panel, decoding 16-bit panels into
+   * scratch.
+   */
+  const float *panel (int p, std::vector<float> &scratch) const;
+
+  matrix_dims _dims;
+  int _panels;
+  bool _is_half;
+  half_format _format;
+  std::vector<float> _values; /** float32 panels. */
+  std::vector<uint16_t> _half_values; /** 16-bit panels. */
+};
+
+#endif //PACKED_H
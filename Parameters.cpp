@@ -0,0 +1,209 @@
+#include "Parameters.h"
+#include "fstream"
+#include "stdexcept"
+#include "vector"
+#include "cstring"
+#include "cmath"
+
+bool readFileToMatrix (const std::string &filePath, Matrix &mat)
+{
+  std::ifstream is;
+  is.open (filePath, std::ios::in | std::ios::binary | std::ios::ate);
+  if (!is.is_open ())
+  {
+    return false;
+  }
+
+  long int matByteSize = (long int) mat.get_cols () * mat.get_rows () *
+                         sizeof (float);
+  if (is.tellg () != matByteSize)
+  {
+    is.close ();
+    return false;
+  }
+
+  is.seekg (0, std::ios_base::beg);
+  is >> mat;
+  is.close ();
+  return true;
+}
+
+bool writeMatrixToFile (const std::string &filePath, const Matrix &mat)
+{
+  std::ofstream os (filePath, std::ios::out | std::ios::binary |
+                              std::ios::trunc);
+  if (!os.is_open ())
+  {
+    return false;
+  }
+  os.write (reinterpret_cast<const char *>(mat.data ()),
+            (long int) mat.get_rows () * mat.get_cols () * sizeof (float));
+  return os.good ();
+}
+
+bool readFileToBytes (const std::string &filePath,
+                      std::vector<unsigned char> &bytes)
+{
+  std::ifstream is;
+  is.open (filePath, std::ios::in | std::ios::binary | std::ios::ate);
+  if (!is.is_open ())
+  {
+    return false;
+  }
+
+  if (is.tellg () != (long int) bytes.size ())
+  {
+    is.close ();
+    return false;
+  }
+
+  is.seekg (0, std::ios_base::beg);
+  if (!is.read (reinterpret_cast<char *>(bytes.data ()),
+                (long int) bytes.size ()))
+  {
+    return false;
+  }
+  is.close ();
+  return true;
+}
+
+bool writeBytesToFile (const std::string &filePath,
+                       const std::vector<unsigned char> &bytes)
+{
+  std::ofstream os (filePath, std::ios::out | std::ios::binary |
+                              std::ios::trunc);
+  if (!os.is_open ())
+  {
+    return false;
+  }
+  os.write (reinterpret_cast<const char *>(bytes.data ()),
+            (long int) bytes.size ());
+  return os.good ();
+}
+
+namespace
+{
+    /**
+     * Returns the tag that starts a 16-bit file of the given format.
+     */
+    const char *halfTag (half_format format)
+    {
+      return format == half_format::FP16 ? FP16_TAG : BF16_TAG;
+    }
+}
+
+bool readHalfFileToMatrix (const std::string &filePath, Matrix &mat,
+                           half_format format)
+{
+  std::ifstream is;
+  is.open (filePath, std::ios::in | std::ios::binary | std::ios::ate);
+  if (!is.is_open ())
+  {
+    return false;
+  }
+
+  int size = mat.get_cols () * mat.get_rows ();
+  if (is.tellg () != (long int) (HALF_TAG_SIZE + size * sizeof (uint16_t)))
+  {
+    is.close ();
+    return false;
+  }
+
+  char tag[HALF_TAG_SIZE];
+  std::vector<uint16_t> values (size);
+  is.seekg (0, std::ios_base::beg);
+  if (!(is.read (tag, HALF_TAG_SIZE)
+        && std::memcmp (tag, halfTag (format), HALF_TAG_SIZE) == 0
+        && is.read (reinterpret_cast<char *>(values.data ()),
+                    size * sizeof (uint16_t))))
+  {
+    return false;
+  }
+  is.close ();
+  half::decode (values.data (), mat.data (), size, format);
+  for (int i = 0; i < size; ++i)
+  {
+    if (!std::isfinite (mat[i]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool writeMatrixToHalfFile (const std::string &filePath, const Matrix &mat,
+                            half_format format)
+{
+  std::ofstream os (filePath, std::ios::out | std::ios::binary |
+                              std::ios::trunc);
+  if (!os.is_open ())
+  {
+    return false;
+  }
+  os.write (halfTag (format), HALF_TAG_SIZE);
+  int size = mat.get_rows () * mat.get_cols ();
+  std::vector<uint16_t> values (size);
+  for (int i = 0; i < size; ++i)
+  {
+    values[i] = half::encode (mat[i], format);
+  }
+  os.write (reinterpret_cast<const char *>(values.data ()),
+            (long int) (size * sizeof (uint16_t)));
+  return os.good ();
+}
+
+namespace
+{
+    /**
+     * Loads count layers' weights and biases of the given dims (see
+     * loadParameters).
+     */
+    void loadLayers (char *paths[], int count, const matrix_dims w_dims[],
+                     const matrix_dims b_dims[], Matrix weights[],
+                     Matrix biases[], weight_storage storage)
+    noexcept (false)
+    {
+      for (int i = 0; i < count; i++)
+      {
+        weights[i] = Matrix (w_dims[i].rows, w_dims[i].cols);
+        biases[i] = Matrix (b_dims[i].rows, b_dims[i].cols);
+
+        std::string weightsPath (paths[i]);
+        std::string biasPath (paths[count + i]);
+
+        bool weightsRead = readFileToMatrix (weightsPath, weights[i]);
+        if (!weightsRead && storage == weight_storage::FP16)
+        {
+          weightsRead = readHalfFileToMatrix (weightsPath, weights[i],
+                                              half_format::FP16);
+        }
+        else if (!weightsRead && storage == weight_storage::BF16)
+        {
+          weightsRead = readHalfFileToMatrix (weightsPath, weights[i],
+                                              half_format::BF16);
+        }
+
+        if (!(weightsRead && readFileToMatrix (biasPath, biases[i])))
+        {
+          auto msg = ERROR_INAVLID_PARAMETER + std::to_string (i + 1);
+          throw std::invalid_argument (msg);
+        }
+      }
+    }
+}
+
+void loadParameters (char *paths[], Matrix weights[MLP_SIZE],
+                     Matrix biases[MLP_SIZE], weight_storage storage)
+noexcept (false)
+{
+  loadLayers (paths, MLP_SIZE, weights_dims, bias_dims, weights, biases,
+              storage);
+}
+
+void loadPreModelParameters (char *paths[], Matrix weights[PRE_SIZE],
+                             Matrix biases[PRE_SIZE], weight_storage storage)
+noexcept (false)
+{
+  loadLayers (paths, PRE_SIZE, pre_weights_dims, pre_bias_dims, weights,
+              biases, storage);
+}
@@ -0,0 +1,125 @@
+#ifndef PARAMETERS_H
+#define PARAMETERS_H
+
+#include "MlpNetwork.h"
+#include "Cascade.h"
+#include "Half.h"
+#include "string"
+#include "vector"
+
+#define ERROR_INAVLID_PARAMETER "Error: invalid Parameters file for layer: "
+#define HALF_TAG_SIZE 4
+#define FP16_TAG "FP16" /** Starts every fp16 weight file. */
+#define BF16_TAG "BF16" /** Starts every bf16 weight file. */
+
+/**
+ * Given a binary file path and a matrix,
+ * reads the content of the file into the matrix.
+ * file must match matrix in size in order to read successfully.
+ * @param filePath - path of the binary file to read
+ * @param mat -  matrix to read the file into.
+ * @return boolean status
+ *          true - success
+ *          false - failure
+ */
+bool readFileToMatrix (const std::string &filePath, Matrix &mat);
+
+/**
+ * Writes the content of a matrix into a binary file (row-major float32, the
+ * same format readFileToMatrix expects).
+ * @param filePath - path of the binary file to write
+ * @param mat - matrix to write.
+ * @return boolean status
+ *          true - success
+ *          false - failure
+ */
+bool writeMatrixToFile (const std::string &filePath, const Matrix &mat);
+
+/**
+ * Given a binary file path and a byte buffer, reads the content of the file
+ * into the buffer (e.g. an image of 8-bit pixels).
+ * file must match the buffer in size in order to read successfully.
+ * @param filePath - path of the binary file to read
+ * @param bytes - buffer to read the file into.
+ * @return boolean status
+ *          true - success
+ *          false - failure
+ */
+bool readFileToBytes (const std::string &filePath,
+                      std::vector<unsigned char> &bytes);
+
+/**
+ * Writes the content of a byte buffer into a binary file.
+ * @param filePath - path of the binary file to write
+ * @param bytes - buffer to write.
+ * @return boolean status
+ *          true - success
+ *          false - failure
+ */
+bool writeBytesToFile (const std::string &filePath,
+                       const std::vector<unsigned char> &bytes);
+
+/**
+ * Given a binary file of 16-bit floats and a matrix, reads the content of the
+ * file into the matrix, converting it to float32.
+ * file must start with the tag of the given format (FP16_TAG / BF16_TAG),
+ * match matrix in size (2 bytes per entry) and decode to finite values in
+ * order to read successfully, so a file of the other format is rejected.
+ * @param filePath - path of the binary file to read
+ * @param mat - matrix to read the file into.
+ * @param format - the 16-bit format of the file.
+ * @return boolean status
+ *          true - success
+ *          false - failure
+ */
+bool readHalfFileToMatrix (const std::string &filePath, Matrix &mat,
+                           half_format format);
+
+/**
+ * Writes the content of a matrix into a binary file of row-major 16-bit
+ * floats, preceded by the format's tag (FP16_TAG / BF16_TAG).
+ * @param filePath - path of the binary file to write
+ * @param mat - matrix to write.
+ * @param format - the 16-bit format to write.
+ * @return boolean status
+ *          true - success
+ *          false - failure
+ */
+bool writeMatrixToHalfFile (const std::string &filePath, const Matrix &mat,
+                            half_format format);
+
+/**
+ * Loads MLP parameters from weights & biases paths
+ * to Weights[] and Biases[].
+ * Throws an exception upon failures.
+ * @param paths array of (2 * MLP_SIZE) paths: the layers' weights followed by
+ *        the layers' biases.
+ * @param weights array of matrix, weigths[i] is the i'th layer weights matrix
+ * @param biases array of matrix, biases[i] is the i'th layer bias matrix
+ *          (which is actually a vector)
+ * @param storage the weight storage the network will use. With FP16 / BF16
+ *        storage the weight files may hold either float32 or 16-bit floats
+ *        of that format; biases are always float32.
+ *  @throw std::invalid_argument in case of problem with a certain argument
+ */
+void loadParameters (char *paths[], Matrix weights[MLP_SIZE],
+                     Matrix biases[MLP_SIZE],
+                     weight_storage storage = weight_storage::DENSE)
+noexcept (false);
+
+/**
+ * Loads the cascade's pre-model parameters from weights & biases paths, like
+ * loadParameters.
+ * @param paths array of (2 * PRE_SIZE) paths: the layers' weights followed
+ *        by the layers' biases.
+ * @param weights array of matrix, weigths[i] is the i'th layer weights matrix
+ * @param biases array of matrix, biases[i] is the i'th layer bias matrix
+ * @param storage the weight storage the pre-model will use.
+ * @throw std::invalid_argument in case of problem with a certain argument
+ */
+void loadPreModelParameters (char *paths[], Matrix weights[PRE_SIZE],
+                             Matrix biases[PRE_SIZE],
+                             weight_storage storage = weight_storage::DENSE)
+noexcept (false);
+
+#endif //PARAMETERS_H
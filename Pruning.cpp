@@ -0,0 +1,66 @@
+#include "Pruning.h"
+#include "stdexcept"
+#include "algorithm"
+#include "vector"
+
+float pruning::prune_blocks (Matrix &mat, float sparsity)
+{
+  if (sparsity < 0 || sparsity > 1)
+  {
+    throw std::invalid_argument ("Error: sparsity must be in [0, 1].");
+  }
+  int rows = mat.get_rows (), cols = mat.get_cols ();
+  int block_rows = (rows + SPARSE_BLOCK_ROWS - 1) / SPARSE_BLOCK_ROWS;
+  int block_cols = (cols + SPARSE_BLOCK_COLS - 1) / SPARSE_BLOCK_COLS;
+  int blocks = block_rows * block_cols;
+  std::vector<float> norms (blocks, 0);
+  float *data = mat.data ();
+  for (int i = 0; i < rows; ++i)
+  {
+    for (int j = 0; j < cols; ++j)
+    {
+      int b = (i / SPARSE_BLOCK_ROWS) * block_cols + j / SPARSE_BLOCK_COLS;
+      norms[b] += data[i * cols + j] * data[i * cols + j];
+    }
+  }
+  // Rank by mean square, so partial edge blocks (fewer entries) are not
+  // pruned first just for being small.
+  std::vector<int> order (blocks);
+  for (int b = 0; b < blocks; ++b)
+  {
+    int r0 = (b / block_cols) * SPARSE_BLOCK_ROWS;
+    int c0 = (b % block_cols) * SPARSE_BLOCK_COLS;
+    int entries = (std::min (r0 + SPARSE_BLOCK_ROWS, rows) - r0)
+                  * (std::min (c0 + SPARSE_BLOCK_COLS, cols) - c0);
+    norms[b] /= entries;
+    order[b] = b;
+  }
+  int pruned = static_cast<int>(sparsity * blocks);
+  std::nth_element (order.begin (), order.begin () + pruned, order.end (),
+                    [&norms] (int a, int b)
+                    { return norms[a] < norms[b]; });
+  for (int k = 0; k < pruned; ++k)
+  {
+    int r0 = (order[k] / block_cols) * SPARSE_BLOCK_ROWS;
+    int c0 = (order[k] % block_cols) * SPARSE_BLOCK_COLS;
+    for (int i = r0; i < std::min (r0 + SPARSE_BLOCK_ROWS, rows); ++i)
+    {
+      for (int j = c0; j < std::min (c0 + SPARSE_BLOCK_COLS, cols); ++j)
+      {
+        data[i * cols + j] = 0;
+      }
+    }
+  }
+  return pruning::sparsity (mat);
+}
+
+float pruning::sparsity (const Matrix &mat)
+{
+  int size = mat.get_rows () * mat.get_cols (), zeros = 0;
+  const float *data = mat.data ();
+  for (int i = 0; i < size; ++i)
+  {
+    zeros += data[i] == 0;
+  }
+  return static_cast<float>(zeros) / size;
+}
@@ -0,0 +1,26 @@
+#ifndef PRUNING_H
+#define PRUNING_H
+#include "BlockSparse.h"
+
+namespace pruning
+{
+    /**
+     * Structured magnitude pruning. Tiles the matrix into
+     * SPARSE_BLOCK_ROWS x SPARSE_BLOCK_COLS blocks (the same tiling
+     * BlockSparseMatrix uses) and zeroes the blocks with the smallest RMS
+     * (Frobenius norm per entry, so partial edge blocks are ranked fairly)
+     * until the requested fraction of blocks is zero.
+     * @param mat The matrix to prune in place.
+     * @param sparsity The target fraction of zero blocks, in [0, 1].
+     * @return The resulting fraction of zero entries in the matrix.
+     */
+    float prune_blocks (Matrix &mat, float sparsity);
+
+    /**
+     * Returns the fraction of zero entries in the matrix.
+     * @param mat The input matrix.
+     * @return The fraction of zero entries.
+     */
+    float sparsity (const Matrix &mat);
+}
+#endif //PRUNING_H
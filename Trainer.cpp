@@ -0,0 +1,346 @@
+#include "Trainer.h"
+#include "algorithm"
+#include "cmath"
+#include "numeric"
+#include "random"
+#include "thread"
+
+#define ADAM_BETA1 0.9f
+#define ADAM_BETA2 0.999f
+#define ADAM_EPS 1e-8f
+#define MIN_PROB 1e-12f
+#define MIN_SHARD 8
+
+namespace
+{
+    /**
+     * Runs task(0..tasks-1), each on its own thread (task 0 on the caller).
+     */
+    template<typename F>
+    void parallel_for (int tasks, const F &task)
+    {
+      std::vector<std::thread> threads;
+      for (int t = 1; t < tasks; ++t)
+      {
+        threads.emplace_back (task, t);
+      }
+      task (0);
+      for (auto &thread: threads)
+      {
+        thread.join ();
+      }
+    }
+}
+
+Trainer::Trainer (const train_config &config, const model_layout &layout)
+    : _config (config), _layout (layout), _step (0)
+{
+  init_layout ();
+  std::mt19937 gen (_config.seed);
+  for (int l = 0; l < _layout.count; ++l)
+  {
+    float limit = std::sqrt (6.0f / in_dim (l));
+    std::uniform_real_distribution<float> dist (-limit, limit);
+    for (int i = 0; i < in_dim (l) * out_dim (l); ++i)
+    {
+      _params[_w_off[l] + i] = dist (gen);
+    }
+  }
+  transpose_weights ();
+}
+
+Trainer::Trainer (const Matrix weights[], const Matrix biases[],
+                  const train_config &config, const model_layout &layout)
+    : _config (config), _layout (layout), _step (0)
+{
+  init_layout ();
+  for (int l = 0; l < _layout.count; ++l)
+  {
+    std::copy (weights[l].data (), weights[l].data () + in_dim (l) *
+                                                        out_dim (l),
+               &_params[_w_off[l]]);
+    std::copy (biases[l].data (), biases[l].data () + out_dim (l),
+               &_params[_b_off[l]]);
+  }
+  transpose_weights ();
+}
+
+void Trainer::init_layout ()
+{
+  int size = 0;
+  _w_off.resize (_layout.count);
+  _b_off.resize (_layout.count);
+  _t_off.resize (_layout.count);
+  for (int l = 0; l < _layout.count; ++l)
+  {
+    _w_off[l] = size, _t_off[l] = size;
+    size += in_dim (l) * out_dim (l);
+    _b_off[l] = size;
+    size += out_dim (l);
+  }
+  _params.assign (size, 0);
+  _transposed.assign (size, 0);
+  _m.assign (size, 0);
+  _v.assign (size, 0);
+  _workspaces.resize (thread_count (_config.batch_size));
+  for (auto &ws: _workspaces)
+  {
+    ws.grads.assign (size, 0);
+  }
+}
+
+int Trainer::thread_count (int images) const
+{
+  int threads = _config.threads > 0 ? _config.threads : static_cast<int>(
+      std::thread::hardware_concurrency ());
+  return std::max (1, std::min (threads, images / MIN_SHARD));
+}
+
+void Trainer::transpose_weights ()
+{
+  for (int l = 0; l < _layout.count; ++l)
+  {
+    transpose (&_params[_w_off[l]], &_transposed[_t_off[l]], out_dim (l),
+               in_dim (l));
+  }
+}
+
+void Trainer::forward (const dataset &data, const int *indices, int n,
+                       workspace &ws) const
+{
+  int pixels = in_dim (0);
+  ws.act.resize (_layout.count + 1);
+  ws.act[0].resize ((size_t) n * pixels);
+  std::vector<float> image (_layout.pooled ? data.pixels : 0);
+  for (int b = 0; b < n; ++b)
+  {
+    float *x = &ws.act[0][(size_t) b * pixels];
+    if (_layout.pooled)
+    {
+      copyDatasetImage (data, indices[b], image.data ());
+      poolImage (image.data (), x);
+    }
+    else
+    {
+      copyDatasetImage (data, indices[b], x);
+    }
+  }
+  for (int l = 0; l < _layout.count; ++l)
+  {
+    int in = in_dim (l), out = out_dim (l);
+    const float *wt = &_transposed[_t_off[l]], *bias = &_params[_b_off[l]];
+    ws.act[l + 1].resize ((size_t) n * out);
+    for (int b = 0; b < n; ++b)
+    {
+      const float *x = &ws.act[l][(size_t) b * in];
+      float *z = &ws.act[l + 1][(size_t) b * out];
+      std::copy_n (bias, out, z);
+      for (int k = 0; k < in; ++k)
+      {
+        if (x[k] == 0)
+        {
+          continue;
+        }
+        const float *wt_row = wt + k * out;
+        for (int o = 0; o < out; ++o)
+        {
+          z[o] += x[k] * wt_row[o];
+        }
+      }
+      if (l < _layout.count - 1)
+      {
+        relu_inplace (z, out);
+      }
+      else
+      {
+        softmax_inplace (z, out);
+      }
+    }
+  }
+}
+
+void Trainer::backward (const dataset &data, const int *indices, int n,
+                        workspace &ws) const
+{
+  int last = _layout.count - 1, classes = out_dim (last);
+  std::vector<float> *delta = &ws.delta[0], *prev = &ws.delta[1];
+  delta->assign (ws.act[last + 1].begin (), ws.act[last + 1].end ());
+  for (int b = 0; b < n; ++b)
+  {
+    int label = data.labels[indices[b]];
+    float prob = (*delta)[(size_t) b * classes + label];
+    ws.loss -= std::log (std::max (prob, MIN_PROB));
+    (*delta)[(size_t) b * classes + label] -= 1;
+  }
+
+  for (int l = last; l >= 0; --l)
+  {
+    int in = in_dim (l), out = out_dim (l);
+    const float *w = &_params[_w_off[l]];
+    float *dw = &ws.grads[_w_off[l]], *db = &ws.grads[_b_off[l]];
+    if (l > 0)
+    {
+      prev->assign ((size_t) n * in, 0);
+    }
+    for (int b = 0; b < n; ++b)
+    {
+      const float *d = &(*delta)[(size_t) b * out];
+      const float *x = &ws.act[l][(size_t) b * in];
+      for (int o = 0; o < out; ++o)
+      {
+        if (d[o] == 0)
+        {
+          continue;
+        }
+        db[o] += d[o];
+        float *dw_row = dw + o * in;
+        for (int k = 0; k < in; ++k)
+        {
+          dw_row[k] += d[o] * x[k];
+        }
+        if (l > 0)
+        {
+          float *dx = &(*prev)[(size_t) b * in];
+          const float *w_row = w + o * in;
+          for (int k = 0; k < in; ++k)
+          {
+            dx[k] += d[o] * w_row[k];
+          }
+        }
+      }
+      if (l > 0)
+      {
+        float *dx = &(*prev)[(size_t) b * in];
+        for (int k = 0; k < in; ++k)
+        {
+          dx[k] = x[k] > 0 ? dx[k] : 0;
+        }
+      }
+    }
+    std::swap (delta, prev);
+  }
+}
+
+void Trainer::update (int begin, int end, int batch)
+{
+  float scale = 1.0f / batch, lr = _config.learning_rate;
+  float correction1 = 1 - std::pow (ADAM_BETA1, (float) _step);
+  float correction2 = 1 - std::pow (ADAM_BETA2, (float) _step);
+  for (int i = begin; i < end; ++i)
+  {
+    float g = 0;
+    for (auto &ws: _workspaces)
+    {
+      g += ws.grads[i];
+      ws.grads[i] = 0;
+    }
+    g *= scale;
+    if (_config.opt == optimizer::SGD)
+    {
+      _params[i] -= lr * g;
+    }
+    else
+    {
+      _m[i] = ADAM_BETA1 * _m[i] + (1 - ADAM_BETA1) * g;
+      _v[i] = ADAM_BETA2 * _v[i] + (1 - ADAM_BETA2) * g * g;
+      float m_hat = _m[i] / correction1, v_hat = _v[i] / correction2;
+      _params[i] -= lr * m_hat / (std::sqrt (v_hat) + ADAM_EPS);
+    }
+  }
+}
+
+float Trainer::train_epoch (const dataset &data)
+{
+  std::vector<int> order (data.count);
+  std::iota (order.begin (), order.end (), 0);
+  std::shuffle (order.begin (), order.end (),
+                std::mt19937 (_config.seed + (unsigned int) _step));
+  float loss = 0;
+  for (int start = 0; start < data.count; start += _config.batch_size)
+  {
+    int batch = std::min (_config.batch_size, data.count - start);
+    int threads = std::min (thread_count (batch),
+                            (int) _workspaces.size ());
+    int shard = (batch + threads - 1) / threads;
+    parallel_for (threads, [&] (int t)
+    {
+      int begin = std::min (batch, t * shard);
+      int n = std::min (batch, begin + shard) - begin;
+      workspace &ws = _workspaces[t];
+      ws.loss = 0;
+      forward (data, &order[start + begin], n, ws);
+      backward (data, &order[start + begin], n, ws);
+    });
+    for (int t = 0; t < threads; ++t)
+    {
+      loss += _workspaces[t].loss;
+    }
+
+    ++_step;
+    int size = static_cast<int>(_params.size ());
+    int slice = (size + threads - 1) / threads;
+    parallel_for (threads, [&] (int t)
+    {
+      update (std::min (size, t * slice), std::min (size, (t + 1) * slice),
+              batch);
+    });
+    transpose_weights ();
+  }
+  return loss / data.count;
+}
+
+namespace
+{
+    /**
+     * Counts the images of a dataset a network classifies correctly, in
+     * parallel over threads.
+     */
+    template<typename N>
+    int count_correct (const N &net, const dataset &data, int threads)
+    {
+      int shard = (data.count + threads - 1) / threads;
+      std::vector<int> correct (threads, 0);
+      parallel_for (threads, [&] (int t)
+      {
+        int begin = std::min (data.count, t * shard);
+        int end = std::min (data.count, begin + shard);
+        for (int i = begin; i < end; ++i)
+        {
+          Matrix img = datasetImage (data, i);
+          correct[t] += net (img).value == data.labels[i];
+        }
+      });
+      return std::accumulate (correct.begin (), correct.end (), 0);
+    }
+}
+
+float Trainer::accuracy (const dataset &data) const
+{
+  std::vector<Matrix> weights (_layout.count), biases (_layout.count);
+  export_parameters (weights.data (), biases.data ());
+  int threads = thread_count (data.count), correct;
+  if (_layout.pooled)
+  {
+    correct = count_correct (PreModel (weights.data (), biases.data ()),
+                             data, threads);
+  }
+  else
+  {
+    correct = count_correct (MlpNetwork (weights.data (), biases.data ()),
+                             data, threads);
+  }
+  return static_cast<float>(correct) / data.count;
+}
+
+void Trainer::export_parameters (Matrix weights[], Matrix biases[]) const
+{
+  for (int l = 0; l < _layout.count; ++l)
+  {
+    weights[l] = Matrix (out_dim (l), in_dim (l));
+    biases[l] = Matrix (out_dim (l), 1);
+    std::copy_n (&_params[_w_off[l]], in_dim (l) * out_dim (l),
+                 weights[l].data ());
+    std::copy_n (&_params[_b_off[l]], out_dim (l), biases[l].data ());
+  }
+}
+
@@ -0,0 +1,163 @@
+#ifndef TRAINER_H
+#define TRAINER_H
+
+#include "MlpNetwork.h"
+#include "Cascade.h"
+#include "Dataset.h"
+#include "vector"
+
+/**
+ * @enum optimizer
+ * Update rule applied to the averaged mini-batch gradient.
+ * SGD - plain stochastic gradient descent.
+ * ADAM - Adam with the usual (0.9, 0.999, 1e-8) hyper-parameters.
+ */
+enum class optimizer
+{
+    SGD, ADAM
+};
+
+/**
+ * @struct train_config
+ * @brief Training hyper-parameters.
+ * @var epochs - number of passes over the training set
+ * @var batch_size - images per mini-batch
+ * @var threads - worker threads a mini-batch is split across (0 - one per
+ *      hardware thread)
+ * @var learning_rate - optimizer step size
+ * @var opt - optimizer
+ * @var seed - seed of the weight initialization and the shuffling
+ */
+typedef struct train_config
+{
+    int epochs, batch_size, threads;
+    float learning_rate;
+    optimizer opt;
+    unsigned int seed;
+} train_config;
+
+const train_config default_train_config = {10, 64, 0, 0.001f,
+                                           optimizer::ADAM, 42};
+
+/**
+ * @struct model_layout
+ * @brief The shape of a network the Trainer trains: dense relu layers
+ * followed by a dense softmax layer.
+ * @var layers - the weights dims of every layer
+ * @var count - the number of layers
+ * @var pooled - whether the network is fed pooled images (see poolImage)
+ */
+typedef struct model_layout
+{
+    const matrix_dims *layers;
+    int count;
+    bool pooled;
+} model_layout;
+
+const model_layout mlp_layout = {weights_dims, MLP_SIZE, false};
+const model_layout pre_model_layout = {pre_weights_dims, PRE_SIZE, true};
+
+/**
+ * Trains the MLP network's parameters on CPU with mini-batch backpropagation.
+ * Every mini-batch is split across worker threads that each run the forward
+ * pass (caching the activations) and the backward pass of the dense / relu /
+ * softmax-cross-entropy layers on their share, accumulating private
+ * gradients. The gradients are then reduced and the optimizer applied in
+ * parallel over slices of the parameters.
+ *
+ * A Dense layer holds its weights packed once for inference and never
+ * changes them, so the trainer keeps the parameters in one mutable buffer
+ * and runs the dense products (forward and backward) as batched kernels on
+ * it, instead of through Dense. The nonlinearities are the activation
+ * kernels the Dense layers use, and accuracy () classifies through an
+ * MlpNetwork (or PreModel) built from the current parameters, so the
+ * reported accuracy is the one inference gets.
+ *
+ * The same engine trains the MLP network and the cascade's pre-model; a
+ * model_layout selects which.
+ */
+class Trainer
+{
+ public:
+  /**
+   * Constructs a trainer with randomly (He-uniform) initialized weights and
+   * zero biases.
+   * @param config The training hyper-parameters.
+   * @param layout The network to train.
+   */
+  explicit Trainer (const train_config &config,
+                    const model_layout &layout = mlp_layout);
+
+  /**
+   * Constructs a trainer starting from existing parameters (fine-tuning).
+   * @param weights An array of weight matrices for each layer.
+   * @param biases An array of bias matrices for each layer.
+   * @param config The training hyper-parameters.
+   * @param layout The network to train.
+   */
+  Trainer (const Matrix weights[], const Matrix biases[],
+           const train_config &config,
+           const model_layout &layout = mlp_layout);
+
+  /**
+   * Runs one epoch over a shuffled training set.
+   * @param data The training set.
+   * @return The mean cross-entropy loss over the epoch.
+   */
+  float train_epoch (const dataset &data);
+
+  /**
+   * Returns the fraction of a dataset the current parameters classify
+   * correctly.
+   * @param data The labeled dataset.
+   * @return The accuracy, in [0, 1].
+   */
+  float accuracy (const dataset &data) const;
+
+  /**
+   * Copies the current parameters out, in the layout MlpNetwork (or
+   * PreModel) and the parameter files use.
+   * @param weights An array of matrices (one per layer) to fill with the
+   *        weights.
+   * @param biases An array of matrices (one per layer) to fill with the
+   *        biases.
+   */
+  void export_parameters (Matrix weights[], Matrix biases[]) const;
+
+  /**
+   * Per-thread buffers holding the cached activations and the gradients of
+   * the thread's share of a mini-batch.
+   */
+  struct workspace
+  {
+      std::vector<std::vector<float>> act; /** act[0] is the input. */
+      std::vector<float> delta[2]; /** Ping-pong back-propagated errors. */
+      std::vector<float> grads;
+      float loss;
+  };
+
+ private:
+  void init_layout ();
+  int in_dim (int l) const
+  { return _layout.layers[l].cols; }
+  int out_dim (int l) const
+  { return _layout.layers[l].rows; }
+  int thread_count (int images) const;
+  void transpose_weights ();
+  void forward (const dataset &data, const int *indices, int n,
+                workspace &ws) const;
+  void backward (const dataset &data, const int *indices, int n,
+                 workspace &ws) const;
+  void update (int begin, int end, int batch);
+
+  train_config _config;
+  model_layout _layout;
+  std::vector<float> _params; /** All weights and biases, layer by layer. */
+  std::vector<float> _transposed; /** Per-layer transposed weights. */
+  std::vector<float> _m, _v; /** Adam moment estimates. */
+  std::vector<workspace> _workspaces;
+  std::vector<int> _w_off, _b_off, _t_off; /** Per-layer offsets. */
+  long int _step;
+};
+
+#endif //TRAINER_H
@@ -0,0 +1,113 @@
+#include "MlpNetwork.h"
+#include "Parameters.h"
+#include "Dataset.h"
+#include "iostream"
+#include "cstring"
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./convert fp16|bf16 out_dir w1 w2 w3 w4 b1 b2 b3 b4\n" \
+                  "\tout_dir - directory the 16-bit w1..w4 and the float32 " \
+                  "b1..b4 are written to\n" \
+                  "\t./convert u8 out_dir img...\n" \
+                  "\tout_dir - directory the 8-bit images are written to"
+#define FORMAT_IDX 1
+#define OUT_DIR_IDX 2
+#define PARAMS_START_IDX 3
+#define ARGS_COUNT (PARAMS_START_IDX + (MLP_SIZE * 2))
+#define FP16_ARG "fp16"
+#define BF16_ARG "bf16"
+#define U8_ARG "u8"
+#define ERROR_INVALID_IMG "Error: invalid image path or size: "
+#define ERROR_WRITE "Error: failed to write: "
+
+/**
+ * Writes float32 images in [0, 1] as 8-bit images (one byte per pixel),
+ * quartering their size. Every image keeps its file name.
+ * @param out_dir directory the images are written to.
+ * @param paths the image paths.
+ * @param count the number of images.
+ * @throw std::invalid_argument in case of an unreadable or unwritable image
+ */
+void convertImages (const std::string &out_dir, char *paths[], int count)
+noexcept (false)
+{
+  Matrix img (img_dims.rows, img_dims.cols);
+  std::vector<unsigned char> bytes (img_dims.rows * img_dims.cols);
+  for (int i = 0; i < count; ++i)
+  {
+    std::string path (paths[i]);
+    if (!readFileToMatrix (path, img))
+    {
+      throw std::invalid_argument (ERROR_INVALID_IMG + path);
+    }
+    for (size_t k = 0; k < bytes.size (); ++k)
+    {
+      bytes[k] = quantizePixel (img[k]);
+    }
+    std::string out_path = out_dir + "/" + path.substr (path.rfind ('/') + 1);
+    if (!writeBytesToFile (out_path, bytes))
+    {
+      throw std::invalid_argument (ERROR_WRITE + out_path);
+    }
+  }
+}
+
+/**
+ * Offline conversion tool. Writes the float32 weight files as 16-bit (fp16
+ * or bf16) files, halving the model size (biases are tiny and stay
+ * float32), or float32 images as 8-bit images.
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code
+ */
+int main (int argc, char **argv)
+{
+  if (argc > OUT_DIR_IDX && std::strcmp (argv[FORMAT_IDX], U8_ARG) == 0)
+  {
+    try
+    {
+      convertImages (argv[OUT_DIR_IDX], argv + OUT_DIR_IDX + 1,
+                     argc - OUT_DIR_IDX - 1);
+    }
+    catch (const std::invalid_argument &invalidArgument)
+    {
+      std::cerr << invalidArgument.what () << std::endl;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+  if (argc != ARGS_COUNT || (std::strcmp (argv[FORMAT_IDX], FP16_ARG) != 0
+                             && std::strcmp (argv[FORMAT_IDX], BF16_ARG) != 0))
+  {
+    std::cerr << USAGE_MSG << std::endl;
+    return EXIT_FAILURE;
+  }
+  half_format format = std::strcmp (argv[FORMAT_IDX], FP16_ARG) == 0
+                       ? half_format::FP16 : half_format::BF16;
+  std::string out_dir (argv[OUT_DIR_IDX]);
+
+  Matrix weights[MLP_SIZE], biases[MLP_SIZE];
+  try
+  {
+    loadParameters (argv + PARAMS_START_IDX, weights, biases);
+    for (int i = 0; i < MLP_SIZE; ++i)
+    {
+      std::string w_path = out_dir + "/w" + std::to_string (i + 1);
+      std::string b_path = out_dir + "/b" + std::to_string (i + 1);
+      if (!writeMatrixToHalfFile (w_path, weights[i], format))
+      {
+        throw std::invalid_argument (ERROR_WRITE + w_path);
+      }
+      if (!writeMatrixToFile (b_path, biases[i]))
+      {
+        throw std::invalid_argument (ERROR_WRITE + b_path);
+      }
+    }
+  }
+  catch (const std::invalid_argument &invalidArgument)
+  {
+    std::cerr << invalidArgument.what () << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,359 @@
+#include "MlpNetwork.h"
+#include "Parameters.h"
+#include "InferencePool.h"
+#include "Cascade.h"
+#include "iostream"
+#include "cstring"
+#include "chrono"
+#include "algorithm"
+#include "cmath"
+#include "sys/resource.h"
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./evaluate (--idx images labels | --list file) " \
+                  "w1 w2 w3 w4 b1 b2 b3 b4\n" \
+                  "\t           [--mode float|u8|batched|cascade] " \
+                  "[--storage dense|sparse|fp16|bf16]\n" \
+                  "\t           [--numa] [--threads N] " \
+                  "[--pre pw1 pw2 pb1 pb2] [--threshold F]\n" \
+                  "\t--idx - MNIST IDX labeled set\n" \
+                  "\t--list - file of \"image label\" lines, image paths " \
+                  "relative to it\n" \
+                  "\t--mode - float: one float32 image at a time (default), " \
+                  "u8: one 8-bit image at a time (float32 sets are " \
+                  "quantized as by convert u8),\n" \
+                  "\t         batched: worker pool (--numa, --threads), " \
+                  "cascade: pre-model (--pre, --threshold) first\n" \
+                  "\t--storage - how the layers store their weights\n" \
+                  "\tPrints a JSON report of accuracy, confusion matrix, " \
+                  "throughput, latency and peak RSS."
+#define SPEC_IDX 1
+#define IDX_ARG "--idx"
+#define LIST_ARG "--list"
+#define CLASSES 10
+#define DEF_THRESHOLD 0.9f
+#define OPTION_ERR "Error: invalid option: "
+#define ERROR_NO_PRE "Error: the cascade mode needs --pre pw1 pw2 pb1 pb2."
+
+/**
+ * @struct eval_options
+ * @brief Parsed command line of the evaluation tool.
+ */
+typedef struct eval_options
+{
+    std::string mode, storage_name;
+    weight_storage storage;
+    bool numa;
+    int threads;
+    char **pre;
+    float threshold;
+} eval_options;
+
+/**
+ * @struct eval_run
+ * @brief Result of running a dataset through one inference mode.
+ * @var predictions - the predicted digit of every image
+ * @var latencies - every image's classification time, in microseconds
+ * @var seconds - wall time of the whole run
+ */
+typedef struct eval_run
+{
+    std::vector<digit> predictions;
+    std::vector<double> latencies;
+    double seconds;
+} eval_run;
+
+/**
+ * Parses the dataset spec (--idx images labels or --list file) leading the
+ * command line.
+ * @param argc count of args
+ * @param argv args values
+ * @return The index of the first parameter path, following the spec.
+ * @throw std::domain_error in case of a missing spec or parameter path
+ */
+int parseDatasetSpec (int argc, char **argv) noexcept (false)
+{
+  int params_idx = 0;
+  if (argc > SPEC_IDX && std::strcmp (argv[SPEC_IDX], IDX_ARG) == 0)
+  {
+    params_idx = SPEC_IDX + 3;
+  }
+  else if (argc > SPEC_IDX && std::strcmp (argv[SPEC_IDX], LIST_ARG) == 0)
+  {
+    params_idx = SPEC_IDX + 2;
+  }
+  if (params_idx == 0 || argc < params_idx + MLP_SIZE * 2)
+  {
+    throw std::domain_error (USAGE_MSG);
+  }
+  return params_idx;
+}
+
+/**
+ * Parses the options following the parameter paths.
+ * @param argc count of args
+ * @param argv args values
+ * @param first The index of the first option.
+ * @param opts set to the parsed options.
+ * @throw std::domain_error in case of an invalid option
+ */
+void parseOptions (int argc, char **argv, int first, eval_options &opts)
+noexcept (false)
+{
+  opts = eval_options{"float", "dense", weight_storage::DENSE, false, 0,
+                      nullptr, DEF_THRESHOLD};
+  for (int i = first; i < argc; ++i)
+  {
+    std::string arg (argv[i]);
+    bool has_value = i + 1 < argc;
+    if (arg == "--mode" && has_value)
+    {
+      opts.mode = argv[++i];
+      if (opts.mode != "float" && opts.mode != "u8" &&
+          opts.mode != "batched" && opts.mode != "cascade")
+      {
+        throw std::domain_error (OPTION_ERR + opts.mode);
+      }
+    }
+    else if (arg == "--storage" && has_value)
+    {
+      opts.storage_name = argv[++i];
+      if (opts.storage_name == "dense")
+      {
+        opts.storage = weight_storage::DENSE;
+      }
+      else if (opts.storage_name == "sparse")
+      {
+        opts.storage = weight_storage::BLOCK_SPARSE;
+      }
+      else if (opts.storage_name == "fp16")
+      {
+        opts.storage = weight_storage::FP16;
+      }
+      else if (opts.storage_name == "bf16")
+      {
+        opts.storage = weight_storage::BF16;
+      }
+      else
+      {
+        throw std::domain_error (OPTION_ERR + opts.storage_name);
+      }
+    }
+    else if (arg == "--numa")
+    {
+      opts.numa = true;
+    }
+    else if (arg == "--threads" && has_value)
+    {
+      opts.threads = std::atoi (argv[++i]);
+    }
+    else if (arg == "--pre" && i + PRE_SIZE * 2 < argc)
+    {
+      opts.pre = argv + i + 1, i += PRE_SIZE * 2;
+    }
+    else if (arg == "--threshold" && has_value)
+    {
+      opts.threshold = std::strtof (argv[++i], nullptr);
+    }
+    else
+    {
+      throw std::domain_error (OPTION_ERR + arg);
+    }
+  }
+  if (opts.mode == "cascade" && !opts.pre)
+  {
+    throw std::domain_error (ERROR_NO_PRE);
+  }
+}
+
+/**
+ * Runs a dataset through a network one image at a time, timing every call.
+ * @param mlp The network.
+ * @param data The dataset.
+ * @param bytes Whether to feed the 8-bit images instead of float32 ones.
+ * @return The predictions and timings.
+ */
+eval_run runSequential (const MlpNetwork &mlp, const dataset &data,
+                        bool bytes)
+{
+  eval_run run{std::vector<digit> (data.count),
+               std::vector<double> (data.count), 0};
+  auto start = std::chrono::steady_clock::now ();
+  for (int i = 0; i < data.count; ++i)
+  {
+    Matrix img = bytes ? Matrix () : datasetImage (data, i);
+    auto begin = std::chrono::steady_clock::now ();
+    run.predictions[i] = bytes ? mlp (datasetBytes (data, i), data.pixels)
+                               : mlp (img);
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now () - begin;
+    run.latencies[i] = elapsed.count ();
+  }
+  std::chrono::duration<double> secs =
+      std::chrono::steady_clock::now () - start;
+  run.seconds = secs.count ();
+  return run;
+}
+
+/**
+ * Runs a dataset through a cascade one image at a time, timing every call.
+ * @param cascade The cascade.
+ * @param data The labeled dataset.
+ * @return The predictions and timings.
+ */
+eval_run runCascade (const CascadeNetwork &cascade, const dataset &data)
+{
+  eval_run run{std::vector<digit> (data.count),
+               std::vector<double> (data.count), 0};
+  auto start = std::chrono::steady_clock::now ();
+  for (int i = 0; i < data.count; ++i)
+  {
+    Matrix img = datasetImage (data, i);
+    auto begin = std::chrono::steady_clock::now ();
+    run.predictions[i] = cascade (img, data.labels[i]);
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now () - begin;
+    run.latencies[i] = elapsed.count ();
+  }
+  std::chrono::duration<double> secs =
+      std::chrono::steady_clock::now () - start;
+  run.seconds = secs.count ();
+  return run;
+}
+
+/**
+ * Returns the nearest-rank percentile of sorted values.
+ */
+double percentile (const std::vector<double> &sorted, double p)
+{
+  size_t rank = static_cast<size_t>(std::ceil (p / 100 * sorted.size ()));
+  return sorted[std::max<size_t> (rank, 1) - 1];
+}
+
+/**
+ * Prints the evaluation report as a JSON object.
+ * @param os The output stream.
+ * @param opts The evaluated options.
+ * @param data The labeled dataset.
+ * @param run The run's predictions and timings.
+ * @param cascade The cascade, in cascade mode (null otherwise).
+ */
+void printReport (std::ostream &os, const eval_options &opts,
+                  const dataset &data, eval_run &run,
+                  const CascadeNetwork *cascade)
+{
+  long confusion[CLASSES][CLASSES] = {{0}};
+  int correct = 0;
+  for (int i = 0; i < data.count; ++i)
+  {
+    unsigned int predicted = run.predictions[i].value;
+    ++confusion[data.labels[i]][predicted];
+    correct += predicted == data.labels[i];
+  }
+  std::sort (run.latencies.begin (), run.latencies.end ());
+  struct rusage usage = {};
+  getrusage (RUSAGE_SELF, &usage);
+
+  os << "{" << std::endl
+     << "  \"mode\": \"" << opts.mode << "\"," << std::endl
+     << "  \"storage\": \"" << opts.storage_name << "\"," << std::endl
+     << "  \"images\": " << data.count << "," << std::endl
+     << "  \"accuracy\": " << static_cast<double>(correct) / data.count << ","
+     << std::endl << "  \"confusion_matrix\": [" << std::endl;
+  for (int label = 0; label < CLASSES; ++label)
+  {
+    os << "    [";
+    for (int predicted = 0; predicted < CLASSES; ++predicted)
+    {
+      os << (predicted ? ", " : "") << confusion[label][predicted];
+    }
+    os << "]" << (label < CLASSES - 1 ? "," : "") << std::endl;
+  }
+  os << "  ]," << std::endl
+     << "  \"images_per_sec\": " << data.count / run.seconds << ","
+     << std::endl
+     << "  \"latency_us\": {\"p50\": " << percentile (run.latencies, 50)
+     << ", \"p99\": " << percentile (run.latencies, 99) << "}," << std::endl
+     << "  \"peak_rss_kb\": " << usage.ru_maxrss;
+  if (cascade)
+  {
+    cascade_stats stats = cascade->stats ();
+    const char *names[CASCADE_STAGES] = {"pre_model", "full"};
+    os << "," << std::endl << "  \"cascade\": {\"threshold\": "
+       << cascade->get_threshold () << ", \"relative_compute\": "
+       << cascadeCost (stats) << ", \"stages\": [";
+    for (int stage = 0; stage < CASCADE_STAGES; ++stage)
+    {
+      os << (stage ? ", " : "") << "{\"name\": \"" << names[stage]
+         << "\", \"images\": " << stats.handled[stage] << ", \"accuracy\": "
+         << (stats.labeled[stage] ? static_cast<double>(stats.correct[stage])
+                                    / stats.labeled[stage] : 0) << "}";
+    }
+    os << "]}";
+  }
+  os << std::endl << "}" << std::endl;
+}
+
+/**
+ * Evaluation harness. Runs a labeled dataset through one inference mode and
+ * prints a JSON report of its accuracy, confusion matrix (rows: true digit,
+ * columns: predicted digit), throughput, p50/p99 latency and peak RSS.
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code
+ */
+int main (int argc, char **argv)
+{
+  eval_options opts;
+  try
+  {
+    int params_idx = parseDatasetSpec (argc, argv);
+    parseOptions (argc, argv, params_idx + MLP_SIZE * 2, opts);
+
+    dataset data = std::strcmp (argv[SPEC_IDX], IDX_ARG) == 0
+                   ? loadIdxDataset (argv[SPEC_IDX + 1], argv[SPEC_IDX + 2])
+                   : loadListDataset (argv[SPEC_IDX + 1]);
+    if (opts.mode == "u8")
+    {
+      quantizeDataset (data);
+    }
+    Matrix weights[MLP_SIZE], biases[MLP_SIZE];
+    loadParameters (argv + params_idx, weights, biases, opts.storage);
+
+    eval_run run;
+    if (opts.mode == "batched")
+    {
+      InferencePool pool (weights, biases, opts.storage, opts.numa,
+                          opts.threads);
+      pool.report (std::cerr);
+      auto start = std::chrono::steady_clock::now ();
+      run.predictions = pool.classify (data, &run.latencies);
+      std::chrono::duration<double> secs =
+          std::chrono::steady_clock::now () - start;
+      run.seconds = secs.count ();
+      printReport (std::cout, opts, data, run, nullptr);
+    }
+    else if (opts.mode == "cascade")
+    {
+      Matrix pre_weights[PRE_SIZE], pre_biases[PRE_SIZE];
+      loadPreModelParameters (opts.pre, pre_weights, pre_biases,
+                              opts.storage);
+      CascadeNetwork cascade (weights, biases, pre_weights, pre_biases,
+                              opts.threshold, opts.storage);
+      run = runCascade (cascade, data);
+      printReport (std::cout, opts, data, run, &cascade);
+    }
+    else
+    {
+      MlpNetwork mlp (weights, biases, opts.storage);
+      run = runSequential (mlp, data, opts.mode == "u8");
+      printReport (std::cout, opts, data, run, nullptr);
+    }
+  }
+  catch (const std::exception &exception)
+  {
+    std::cerr << exception.what () << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -3,22 +3,34 @@
 #include "Activation.h"
 #include "Dense.h"
 #include "MlpNetwork.h"
+#include "Parameters.h"
+#include "ModelHandle.h"
 #include "iostream"
+#include "cstring"
 
 #define QUIT "q"
 #define INSERT_IMAGE_PATH "Please insert image path:"
-#define ERROR_INAVLID_PARAMETER "Error: invalid Parameters file for layer: "
 #define ERROR_INVALID_INPUT "Error: Failed to retrieve input. Exiting.."
 #define ERROR_INVALID_IMG "Error: invalid image path or size: "
 #define USAGE_MSG "Usage:\n" \
-                  "\t./mlpnetwork w1 w2 w3 w4 b1 b2 b3 b4\n" \
+                  "\t./mlpnetwork w1 w2 w3 w4 b1 b2 b3 b4 " \
+                  "[--sparse | --fp16 | --bf16] [--watch]\n" \
                   "\twi - the i'th layer's weights\n" \
-                  "\tbi - the i'th layer's biases"
+                  "\tbi - the i'th layer's biases\n" \
+                  "\t--sparse - run the layers in block-sparse mode\n" \
+                  "\t--fp16, --bf16 - store the weights as 16-bit floats " \
+                  "(wi may be float32 or 16-bit files)\n" \
+                  "\t--watch - reload the parameters on SIGHUP or when " \
+                  "their files change"
 #define USAGE_ERR "Error: wrong number of arguments."
+#define OPTION_ERR "Error: unknown option: "
+#define SPARSE_OPT "--sparse"
+#define FP16_OPT "--fp16"
+#define BF16_OPT "--bf16"
+#define WATCH_OPT "--watch"
 #define ARGS_START_IDX 1
 #define ARGS_COUNT (ARGS_START_IDX + (MLP_SIZE * 2))
 #define WEIGHTS_START_IDX ARGS_START_IDX
-#define BIAS_START_IDX (ARGS_START_IDX + MLP_SIZE)
 
 /**
  * Prints program usage to stdout.
@@ -27,7 +39,7 @@
  */
 void usage (int argc) noexcept (false)
 {
-  if (argc != ARGS_COUNT)
+  if (argc < ARGS_COUNT)
   {
     throw std::domain_error (USAGE_ERR);
   }
@@ -35,67 +47,40 @@ void usage (int argc) noexcept (false)
 }
 
 /**
- * Given a binary file path and a matrix,
- * reads the content of the file into the matrix.
- * file must match matrix in size in order to read successfully.
- * @param filePath - path of the binary file to read
- * @param mat -  matrix to read the file into.
- * @return boolean status
- *          true - success
- *          false - failure
- */
-bool readFileToMatrix (const std::string &filePath, Matrix &mat)
-{
-  std::ifstream is;
-  is.open (filePath, std::ios::in | std::ios::binary | std::ios::ate);
-  if (!is.is_open ())
-  {
-    return false;
-  }
-
-  long int matByteSize = (long int) mat.get_cols () * mat.get_rows () *
-                         sizeof (float);
-  if (is.tellg () != matByteSize)
-  {
-    is.close ();
-    return false;
-  }
-
-  is.seekg (0, std::ios_base::beg);
-  is >> mat;
-  is.close ();
-  return true;
-}
-
-/**
- * Loads MLP parameters from weights & biases paths
- * to Weights[] and Biases[].
- * Throws an exception upon failures.
- * @param paths array of programs arguments, expected to be mlp parameters
- *        path.
- * @param weights array of matrix, weigths[i] is the i'th layer weights matrix
- * @param biases array of matrix, biases[i] is the i'th layer bias matrix
- *          (which is actually a vector)
- *  @throw std::invalid_argument in case of problem with a certain argument
+ * Parses the optional flags following the parameter paths.
+ * @param argc count of args
+ * @param argv args values
+ * @param storage set to the weight storage requested by the flags.
+ * @param watch set to whether the parameter files should be watched.
+ * @throw std::domain_error in case of an unknown option
  */
-void loadParameters (char *paths[ARGS_COUNT], Matrix weights[MLP_SIZE],
-                     Matrix biases[MLP_SIZE]) noexcept (false)
+void parseOptions (int argc, char **argv, weight_storage &storage,
+                   bool &watch) noexcept (false)
 {
-  for (int i = 0; i < MLP_SIZE; i++)
+  storage = weight_storage::DENSE;
+  watch = false;
+  for (int i = ARGS_COUNT; i < argc; ++i)
   {
-    weights[i] = Matrix (weights_dims[i].rows, weights_dims[i].cols);
-    biases[i] = Matrix (bias_dims[i].rows, bias_dims[i].cols);
-
-    std::string weightsPath (paths[WEIGHTS_START_IDX + i]);
-    std::string biasPath (paths[BIAS_START_IDX + i]);
-
-    if (!(readFileToMatrix (weightsPath, weights[i]) &&
-          readFileToMatrix (biasPath, biases[i])))
+    if (std::strcmp (argv[i], SPARSE_OPT) == 0)
     {
-      auto msg = ERROR_INAVLID_PARAMETER + std::to_string (i + 1);
-      throw std::invalid_argument (msg);
+      storage = weight_storage::BLOCK_SPARSE;
+    }
+    else if (std::strcmp (argv[i], FP16_OPT) == 0)
+    {
+      storage = weight_storage::FP16;
+    }
+    else if (std::strcmp (argv[i], BF16_OPT) == 0)
+    {
+      storage = weight_storage::BF16;
+    }
+    else if (std::strcmp (argv[i], WATCH_OPT) == 0)
+    {
+      watch = true;
+    }
+    else
+    {
+      throw std::domain_error (OPTION_ERR + std::string (argv[i]));
     }
-
   }
 }
 
@@ -107,12 +92,14 @@ void loadParameters (char *paths[ARGS_COUNT], Matrix weights[MLP_SIZE],
  *                  print image & netowrk prediction
  *             }
  * Throws an exception on fatal errors: unable to read user input path.
- * @param mlp MlpNetwork to use in order to predict img.
+ * @param model handle of the MlpNetwork to use in order to predict img; the
+ *        current network is acquired for every image.
  * @throw std::invalid_argument in case of problem with the user input path
  */
-void mlpCli (MlpNetwork &mlp) noexcept (false)
+void mlpCli (const ModelHandle &model) noexcept (false)
 {
   Matrix img (img_dims.rows, img_dims.cols);
+  std::vector<unsigned char> imgBytes (img_dims.rows * img_dims.cols);
   std::string imgPath;
 
   std::cout << INSERT_IMAGE_PATH << std::endl;
@@ -124,19 +111,29 @@ void mlpCli (MlpNetwork &mlp) noexcept (false)
 
   while (imgPath != QUIT)
   {
+    std::shared_ptr<const MlpNetwork> mlp = model.acquire ();
+    digit output;
     if (readFileToMatrix (imgPath, img))
     {
       Matrix imgVec = img;
-      digit output = mlp (imgVec.vectorize ());
-      std::cout << "Image processed:" << std::endl
-                << img << std::endl;
-      std::cout << "Mlp result: " << output.value <<
-                " at probability: " << output.probability << std::endl;
+      output = (*mlp) (imgVec.vectorize ());
+    }
+    else if (readFileToBytes (imgPath, imgBytes))
+    {
+      output = (*mlp) (imgBytes);
+      for (int i = 0; i < img_dims.rows * img_dims.cols; ++i)
+      {
+        img[i] = imgBytes[i] / PIXEL_MAX;
+      }
     }
     else
     {
       throw std::invalid_argument (ERROR_INVALID_IMG + imgPath);
     }
+    std::cout << "Image processed:" << std::endl
+              << img << std::endl;
+    std::cout << "Mlp result: " << output.value <<
+              " at probability: " << output.probability << std::endl;
 
     std::cout << INSERT_IMAGE_PATH << std::endl;
     std::cin >> imgPath;
@@ -155,9 +152,12 @@ void mlpCli (MlpNetwork &mlp) noexcept (false)
  */
 int main (int argc, char **argv)
 {
+  weight_storage storage;
+  bool watch;
   try
   {
     usage (argc);
+    parseOptions (argc, argv, storage, watch);
   }
   catch (const std::domain_error &domainError)
   {
@@ -166,12 +166,11 @@ int main (int argc, char **argv)
 
   }
 
-  Matrix weights[MLP_SIZE];
-  Matrix biases[MLP_SIZE];
+  std::unique_ptr<ModelHandle> model;
 
   try
   {
-    loadParameters (argv, weights, biases);
+    model.reset (new ModelHandle (argv + WEIGHTS_START_IDX, storage));
 
   }
   catch (const std::invalid_argument &invalidArgument)
@@ -180,11 +179,14 @@ int main (int argc, char **argv)
     return EXIT_FAILURE;
   }
 
-  MlpNetwork mlp (weights, biases);
+  if (watch)
+  {
+    model->start_watching ();
+  }
 
   try
   {
-    mlpCli (mlp);
+    mlpCli (*model);
   }
 
   catch (const std::invalid_argument &invalidArgument)
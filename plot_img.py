@@ -17,7 +17,10 @@ def main(argv):
         print("Error: invalid path given: ", im_path)
         return
 
-    img = np.fromfile(im_path, dtype=np.float32)
+    if os.path.getsize(im_path) == IMG_LEN:
+        img = np.fromfile(im_path, dtype=np.uint8)
+    else:
+        img = np.fromfile(im_path, dtype=np.float32)
     if img.size != IMG_LEN:
         print("Unknown img file len")
 
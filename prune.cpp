@@ -0,0 +1,120 @@
+#include "MlpNetwork.h"
+#include "Parameters.h"
+#include "Pruning.h"
+#include "iostream"
+#include "cstdlib"
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./prune sparsity out_dir w1 w2 w3 w4 b1 b2 b3 b4 " \
+                  "[img label]...\n" \
+                  "\tsparsity - target fraction of zero weight blocks\n" \
+                  "\tout_dir - directory the pruned w1..w4, b1..b4 are " \
+                  "written to\n" \
+                  "\timg label - labeled images the accuracy delta is " \
+                  "measured on"
+#define SPARSITY_IDX 1
+#define OUT_DIR_IDX 2
+#define PARAMS_START_IDX 3
+#define ARGS_COUNT (PARAMS_START_IDX + (MLP_SIZE * 2))
+#define ERROR_INVALID_IMG "Error: invalid image path or size: "
+#define ERROR_WRITE "Error: failed to write: "
+
+/**
+ * Returns the fraction of labeled images the network classifies correctly.
+ * @param mlp The network to evaluate.
+ * @param images The images, as 784x1 vectors.
+ * @param labels The expected digit of each image.
+ * @param count The number of labeled images.
+ * @return The accuracy, in [0, 1].
+ */
+float accuracy (const MlpNetwork &mlp, const Matrix images[],
+                const unsigned int labels[], int count)
+{
+  int correct = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    Matrix img = images[i];
+    correct += mlp (img).value == labels[i];
+  }
+  return static_cast<float>(correct) / count;
+}
+
+/**
+ * Offline pruning tool. Zeroes the lowest-magnitude weight blocks of every
+ * layer to the target sparsity, writes the pruned parameters and reports the
+ * accuracy before and after pruning on the given labeled images.
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code
+ */
+int main (int argc, char **argv)
+{
+  if (argc < ARGS_COUNT || (argc - ARGS_COUNT) % 2 != 0)
+  {
+    std::cerr << USAGE_MSG << std::endl;
+    return EXIT_FAILURE;
+  }
+  float target = std::strtof (argv[SPARSITY_IDX], nullptr);
+  std::string out_dir (argv[OUT_DIR_IDX]);
+  int count = (argc - ARGS_COUNT) / 2;
+
+  Matrix weights[MLP_SIZE], biases[MLP_SIZE], pruned[MLP_SIZE];
+  Matrix *images = new Matrix[count];
+  unsigned int *labels = new unsigned int[count];
+  int status = EXIT_SUCCESS;
+  try
+  {
+    loadParameters (argv + PARAMS_START_IDX, weights, biases);
+    for (int i = 0; i < count; ++i)
+    {
+      std::string img_path (argv[ARGS_COUNT + 2 * i]);
+      images[i] = Matrix (img_dims.rows, img_dims.cols);
+      if (!readFileToMatrix (img_path, images[i]))
+      {
+        throw std::invalid_argument (ERROR_INVALID_IMG + img_path);
+      }
+      images[i].vectorize ();
+      labels[i] = std::strtoul (argv[ARGS_COUNT + 2 * i + 1], nullptr, 10);
+    }
+
+    for (int i = 0; i < MLP_SIZE; ++i)
+    {
+      pruned[i] = weights[i];
+      float zeros = pruning::prune_blocks (pruned[i], target);
+      std::cout << "Layer " << i + 1 << ": " << zeros * 100
+                << "% zero weights, " << BlockSparseMatrix (pruned[i])
+                    .block_sparsity () * 100 << "% zero blocks" << std::endl;
+
+      std::string w_path = out_dir + "/w" + std::to_string (i + 1);
+      std::string b_path = out_dir + "/b" + std::to_string (i + 1);
+      if (!writeMatrixToFile (w_path, pruned[i]))
+      {
+        throw std::invalid_argument (ERROR_WRITE + w_path);
+      }
+      if (!writeMatrixToFile (b_path, biases[i]))
+      {
+        throw std::invalid_argument (ERROR_WRITE + b_path);
+      }
+    }
+
+    if (count > 0)
+    {
+      MlpNetwork dense (weights, biases);
+      MlpNetwork sparse (pruned, biases, weight_storage::BLOCK_SPARSE);
+      float before = accuracy (dense, images, labels, count);
+      float after = accuracy (sparse, images, labels, count);
+      std::cout << "Accuracy before: " << before * 100 << "%" << std::endl
+                << "Accuracy after: " << after * 100 << "%" << std::endl
+                << "Accuracy delta: " << (after - before) * 100 << "%"
+                << std::endl;
+    }
+  }
+  catch (const std::invalid_argument &invalidArgument)
+  {
+    std::cerr << invalidArgument.what () << std::endl;
+    status = EXIT_FAILURE;
+  }
+  delete[] images;
+  delete[] labels;
+  return status;
+}
@@ -0,0 +1,249 @@
+#include "MlpNetwork.h"
+#include "Parameters.h"
+#include "Trainer.h"
+#include "Cascade.h"
+#include "iostream"
+#include "cstring"
+#include "chrono"
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./train images labels out_dir [--test images labels] " \
+                  "[--init w1 w2 w3 w4 b1 b2 b3 b4]\n" \
+                  "\t        [--epochs N] [--batch N] [--lr F] [--sgd] " \
+                  "[--threads N] [--seed N]\n" \
+                  "\t        [--pre-model [--tolerance F]]\n" \
+                  "\timages labels - MNIST IDX training set\n" \
+                  "\tout_dir - directory the trained w1..w4, b1..b4 are " \
+                  "written to\n" \
+                  "\t--test - MNIST IDX set the accuracy is reported on\n" \
+                  "\t--init - fine-tune these parameters instead of " \
+                  "training from scratch\n" \
+                  "\t--sgd - use plain SGD instead of Adam\n" \
+                  "\t--pre-model - train the cascade's pre-model instead, " \
+                  "write it to out_dir/pw1, pw2, pb1, pb2 and, given the " \
+                  "full network as --init and a --test set, sweep the " \
+                  "cascade thresholds, recommending the lowest one within " \
+                  "--tolerance (default 0.005) of the full network's " \
+                  "accuracy"
+#define IMAGES_IDX 1
+#define LABELS_IDX 2
+#define OUT_DIR_IDX 3
+#define ARGS_COUNT 4
+#define OPTION_ERR "Error: invalid option: "
+#define ERROR_WRITE "Error: failed to write: "
+#define DEF_TOLERANCE 0.005f
+#define NO_THRESHOLD_MSG "No threshold keeps the accuracy within the " \
+                         "tolerance; do not use this pre-model."
+
+const float sweep_thresholds[] = {0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 0.95f, 0.99f,
+                                  0.999f};
+
+/**
+ * Returns whether argv[i] is the given option followed by at least values
+ * more arguments.
+ */
+bool isOption (int argc, char **argv, int i, const char *option, int values)
+{
+  return std::strcmp (argv[i], option) == 0 && i + values < argc;
+}
+
+/**
+ * Reports the exit rate, accuracy and relative compute of the cascade at
+ * every sweep threshold on a labeled set, and recommends the lowest
+ * threshold whose accuracy is within tolerance of the full network's.
+ * @param weights An array of (4) weight matrices for each layer.
+ * @param biases An array of (4) bias matrices for each layer.
+ * @param pre_weights An array of (2) pre-model weight matrices.
+ * @param pre_biases An array of (2) pre-model bias matrices.
+ * @param test The labeled set.
+ * @param tolerance The accepted accuracy loss.
+ */
+void sweepThresholds (const Matrix weights[], const Matrix biases[],
+                      const Matrix pre_weights[], const Matrix pre_biases[],
+                      const dataset &test, float tolerance)
+{
+  MlpNetwork mlp (weights, biases);
+  PreModel pre (pre_weights, pre_biases);
+  std::vector<digit> full (test.count), early (test.count);
+  int full_correct = 0;
+  for (int i = 0; i < test.count; ++i)
+  {
+    Matrix img = datasetImage (test, i);
+    early[i] = pre (img);
+    full[i] = mlp (img);
+    full_correct += full[i].value == test.labels[i];
+  }
+  float full_accuracy = static_cast<float>(full_correct) / test.count;
+  std::cout << "Full network accuracy: " << full_accuracy * 100 << "%"
+            << std::endl;
+  float recommended = 0;
+  bool found = false;
+  for (float threshold: sweep_thresholds)
+  {
+    cascade_stats stats = {};
+    int correct = 0;
+    for (int i = 0; i < test.count; ++i)
+    {
+      bool exit = early[i].probability >= threshold;
+      ++stats.handled[exit ? 0 : 1];
+      correct += (exit ? early[i] : full[i]).value == test.labels[i];
+    }
+    float accuracy = static_cast<float>(correct) / test.count;
+    std::cout << "Threshold " << threshold << ": early exit "
+              << 100.0f * stats.handled[0] / test.count << "%, accuracy "
+              << accuracy * 100 << "%, compute "
+              << cascadeCost (stats) * 100 << "%" << std::endl;
+    if (!found && accuracy >= full_accuracy - tolerance)
+    {
+      recommended = threshold, found = true;
+    }
+  }
+  if (found)
+  {
+    std::cout << "Recommended threshold: " << recommended << std::endl;
+  }
+  else
+  {
+    std::cout << NO_THRESHOLD_MSG << std::endl;
+  }
+}
+
+/**
+ * Training tool. Trains (or fine-tunes) the network on an MNIST IDX training
+ * set and exports the parameters in the w1..w4, b1..b4 format, or trains
+ * the cascade's pre-model and exports it as pw1, pw2, pb1, pb2.
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code
+ */
+int main (int argc, char **argv)
+{
+  if (argc < ARGS_COUNT)
+  {
+    std::cerr << USAGE_MSG << std::endl;
+    return EXIT_FAILURE;
+  }
+  train_config config = default_train_config;
+  char **init = nullptr;
+  bool pre_model = false;
+  float tolerance = DEF_TOLERANCE;
+  const char *test_images = nullptr, *test_labels = nullptr;
+  for (int i = ARGS_COUNT; i < argc; ++i)
+  {
+    if (isOption (argc, argv, i, "--test", 2))
+    {
+      test_images = argv[i + 1], test_labels = argv[i + 2], i += 2;
+    }
+    else if (isOption (argc, argv, i, "--init", MLP_SIZE * 2))
+    {
+      init = argv + i + 1, i += MLP_SIZE * 2;
+    }
+    else if (isOption (argc, argv, i, "--epochs", 1))
+    {
+      config.epochs = std::atoi (argv[++i]);
+    }
+    else if (isOption (argc, argv, i, "--batch", 1))
+    {
+      config.batch_size = std::atoi (argv[++i]);
+    }
+    else if (isOption (argc, argv, i, "--lr", 1))
+    {
+      config.learning_rate = std::strtof (argv[++i], nullptr);
+    }
+    else if (isOption (argc, argv, i, "--threads", 1))
+    {
+      config.threads = std::atoi (argv[++i]);
+    }
+    else if (isOption (argc, argv, i, "--seed", 1))
+    {
+      config.seed = std::strtoul (argv[++i], nullptr, 10);
+    }
+    else if (isOption (argc, argv, i, "--pre-model", 0))
+    {
+      pre_model = true;
+    }
+    else if (isOption (argc, argv, i, "--tolerance", 1))
+    {
+      tolerance = std::strtof (argv[++i], nullptr);
+    }
+    else if (isOption (argc, argv, i, "--sgd", 0))
+    {
+      config.opt = optimizer::SGD;
+    }
+    else
+    {
+      std::cerr << OPTION_ERR << argv[i] << std::endl << USAGE_MSG
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (config.epochs <= 0 || config.batch_size <= 0)
+  {
+    std::cerr << USAGE_MSG << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try
+  {
+    dataset train = loadIdxDataset (argv[IMAGES_IDX], argv[LABELS_IDX]);
+    dataset test;
+    if (test_images)
+    {
+      test = loadIdxDataset (test_images, test_labels);
+    }
+
+    Matrix weights[MLP_SIZE], biases[MLP_SIZE];
+    if (init)
+    {
+      loadParameters (init, weights, biases);
+    }
+    model_layout layout = pre_model ? pre_model_layout : mlp_layout;
+    Trainer trainer = init && !pre_model ? Trainer (weights, biases, config)
+                                         : Trainer (config, layout);
+
+    for (int epoch = 1; epoch <= config.epochs; ++epoch)
+    {
+      auto start = std::chrono::steady_clock::now ();
+      float loss = trainer.train_epoch (train);
+      std::chrono::duration<double> secs =
+          std::chrono::steady_clock::now () - start;
+      std::cout << "Epoch " << epoch << ": loss " << loss << ", "
+                << secs.count () << "s";
+      if (test_images)
+      {
+        std::cout << ", test accuracy " << trainer.accuracy (test) * 100
+                  << "%";
+      }
+      std::cout << std::endl;
+    }
+
+    std::vector<Matrix> out_w (layout.count), out_b (layout.count);
+    trainer.export_parameters (out_w.data (), out_b.data ());
+    std::string prefix = std::string (argv[OUT_DIR_IDX]) +
+                         (pre_model ? "/p" : "/");
+    for (int i = 0; i < layout.count; ++i)
+    {
+      std::string w_path = prefix + "w" + std::to_string (i + 1);
+      std::string b_path = prefix + "b" + std::to_string (i + 1);
+      if (!writeMatrixToFile (w_path, out_w[i]))
+      {
+        throw std::invalid_argument (ERROR_WRITE + w_path);
+      }
+      if (!writeMatrixToFile (b_path, out_b[i]))
+      {
+        throw std::invalid_argument (ERROR_WRITE + b_path);
+      }
+    }
+    if (pre_model && init && test_images)
+    {
+      sweepThresholds (weights, biases, out_w.data (), out_b.data (), test,
+                       tolerance);
+    }
+  }
+  catch (const std::invalid_argument &invalidArgument)
+  {
+    std::cerr << invalidArgument.what () << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}